@@ -0,0 +1,198 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// arc_replacer.cpp
+//
+// Identification: src/buffer/arc_replacer.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/arc_replacer.h"
+
+#include <algorithm>
+
+namespace bustub {
+
+ARCReplacer::ARCReplacer(size_t num_pages) : capacity_(num_pages) {
+  entries_.reserve(num_pages);
+  ghosts_.reserve(num_pages);
+}
+
+ARCReplacer::~ARCReplacer() = default;
+
+bool ARCReplacer::Victim(frame_id_t *frame_id) {
+  std::scoped_lock lock(latch_);
+  if (t1_.empty() && t2_.empty()) {
+    return false;
+  }
+  const bool recent = PreferRecent(t1_size_, t1_.empty(), t2_.empty());
+  auto &victims = recent ? t1_ : t2_;
+  *frame_id = victims.back();
+  victims.pop_back();
+  auto it = entries_.find(*frame_id);
+  const page_id_t page_id = it->second.page_id_;
+  entries_.erase(it);
+  if (recent) {
+    t1_size_--;
+  } else {
+    t2_size_--;
+  }
+  if (page_id != INVALID_PAGE_ID) {
+    AddGhost(page_id, !recent);
+  }
+  return true;
+}
+
+void ARCReplacer::Pin(frame_id_t frame_id) {
+  std::scoped_lock lock(latch_);
+  auto &entry = EntryOf(frame_id);
+  if (entry.evictable_) {
+    (entry.frequent_ ? t2_ : t1_).erase(entry.position_);
+    entry.evictable_ = false;
+  }
+  // The first pin is the access that brought the page in, only a second one makes it frequent.
+  if (++entry.accesses_ >= 2 && !entry.frequent_) {
+    entry.frequent_ = true;
+    t1_size_--;
+    t2_size_++;
+  }
+}
+
+void ARCReplacer::Unpin(frame_id_t frame_id) {
+  std::scoped_lock lock(latch_);
+  auto &entry = EntryOf(frame_id);
+  if (entry.evictable_) {
+    return;
+  }
+  auto &list = entry.frequent_ ? t2_ : t1_;
+  list.push_front(frame_id);
+  entry.position_ = list.begin();
+  entry.evictable_ = true;
+}
+
+void ARCReplacer::AssignPage(frame_id_t frame_id, page_id_t page_id) {
+  std::scoped_lock lock(latch_);
+  auto &entry = EntryOf(frame_id);
+  if (entry.evictable_) {
+    (entry.frequent_ ? t2_ : t1_).erase(entry.position_);
+    entry.evictable_ = false;
+  }
+  if (entry.frequent_) {
+    t2_size_--;
+    t1_size_++;
+  }
+  entry.page_id_ = page_id;
+  entry.frequent_ = false;
+  entry.accesses_ = 0;
+
+  auto ghost = ghosts_.find(page_id);
+  if (ghost == ghosts_.end()) {
+    return;
+  }
+  // The page was evicted too early. Had the list it was evicted from been larger, it would still be resident, so
+  // shift the target towards that list, by more the smaller its ghost list is compared to the other one.
+  if (ghost->second.frequent_) {
+    const size_t delta = std::max<size_t>(1, b1_.size() / b2_.size());
+    target_t1_ = target_t1_ > delta ? target_t1_ - delta : 0;
+    b2_.erase(ghost->second.position_);
+  } else {
+    const size_t delta = std::max<size_t>(1, b2_.size() / b1_.size());
+    target_t1_ = std::min(capacity_, target_t1_ + delta);
+    b1_.erase(ghost->second.position_);
+  }
+  ghosts_.erase(ghost);
+  // Seen twice now, the page goes straight to T2.
+  entry.frequent_ = true;
+  entry.accesses_ = 1;
+  t1_size_--;
+  t2_size_++;
+}
+
+void ARCReplacer::Remove(frame_id_t frame_id) {
+  std::scoped_lock lock(latch_);
+  auto it = entries_.find(frame_id);
+  if (it == entries_.end()) {
+    return;
+  }
+  auto &entry = it->second;
+  if (entry.evictable_) {
+    (entry.frequent_ ? t2_ : t1_).erase(entry.position_);
+  }
+  if (entry.frequent_) {
+    t2_size_--;
+  } else {
+    t1_size_--;
+  }
+  entries_.erase(it);
+}
+
+void ARCReplacer::PeekVictims(size_t max_frames, std::vector<frame_id_t> *frame_ids) {
+  std::scoped_lock lock(latch_);
+  // Replay the choices Victim() would make, without the ghosts it would add.
+  auto t1_it = t1_.rbegin();
+  auto t2_it = t2_.rbegin();
+  size_t t1_size = t1_size_;
+  for (; max_frames > 0 && (t1_it != t1_.rend() || t2_it != t2_.rend()); --max_frames) {
+    if (PreferRecent(t1_size, t1_it == t1_.rend(), t2_it == t2_.rend())) {
+      frame_ids->push_back(*t1_it++);
+      t1_size--;
+    } else {
+      frame_ids->push_back(*t2_it++);
+    }
+  }
+}
+
+size_t ARCReplacer::Size() {
+  std::scoped_lock lock(latch_);
+  return t1_.size() + t2_.size();
+}
+
+size_t ARCReplacer::GetTargetRecencySize() {
+  std::scoped_lock lock(latch_);
+  return target_t1_;
+}
+
+ARCReplacer::FrameEntry &ARCReplacer::EntryOf(frame_id_t frame_id) {
+  auto [it, inserted] = entries_.try_emplace(frame_id);
+  if (inserted) {
+    t1_size_++;
+  }
+  return it->second;
+}
+
+bool ARCReplacer::PreferRecent(size_t t1_size, bool t1_empty, bool t2_empty) const {
+  if (t1_empty || t2_empty) {
+    return !t1_empty;
+  }
+  return t1_size > target_t1_;
+}
+
+void ARCReplacer::AddGhost(page_id_t page_id, bool frequent) {
+  // A frame the replacer was not told about may have brought the page back without taking it out of the ghosts.
+  auto it = ghosts_.find(page_id);
+  if (it != ghosts_.end()) {
+    (it->second.frequent_ ? b2_ : b1_).erase(it->second.position_);
+    ghosts_.erase(it);
+  }
+  auto &list = frequent ? b2_ : b1_;
+  list.push_front(page_id);
+  ghosts_.emplace(page_id, GhostEntry{frequent, list.begin()});
+  // The recency side remembers at most c pages in all, resident or not, and everything together at most 2c.
+  while (!b1_.empty() && t1_size_ + b1_.size() > capacity_) {
+    DropGhost(false);
+  }
+  while (!ghosts_.empty() && t1_size_ + t2_size_ + ghosts_.size() > 2 * capacity_) {
+    DropGhost(!b2_.empty());
+  }
+}
+
+void ARCReplacer::DropGhost(bool frequent) {
+  auto &list = frequent ? b2_ : b1_;
+  ghosts_.erase(list.back());
+  list.pop_back();
+}
+
+}  // namespace bustub
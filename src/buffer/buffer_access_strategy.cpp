@@ -0,0 +1,30 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_access_strategy.cpp
+//
+// Identification: src/buffer/buffer_access_strategy.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/buffer_access_strategy.h"
+
+#include "buffer/buffer_pool_manager.h"
+
+namespace bustub {
+
+std::atomic<uint64_t> BufferAccessStrategy::next_id_{1};
+
+BufferAccessStrategy::BufferAccessStrategy(BufferPoolManager *buffer_pool_manager, BufferAccessStrategyType type)
+    : buffer_pool_manager_(buffer_pool_manager), type_(type), id_(next_id_.fetch_add(1)) {}
+
+BufferAccessStrategy::~BufferAccessStrategy() { buffer_pool_manager_->ReleaseAccessStrategy(id_); }
+
+bool BufferAccessStrategy::IsLargeRelation(BufferPoolManager *buffer_pool_manager, size_t num_pages) {
+  return num_pages > buffer_pool_manager->GetPoolSize() / BULK_RELATION_FRACTION;
+}
+
+}  // namespace bustub
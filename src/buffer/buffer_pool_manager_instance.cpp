@@ -12,86 +12,1049 @@
 
 #include "buffer/buffer_pool_manager_instance.h"
 
+#include <sys/mman.h>
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <fstream>
+#include <new>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "common/exception.h"
+#include "common/logger.h"
 #include "common/macros.h"
+#include "common/util/file_util.h"
+#include "common/util/numa_util.h"
 
 namespace bustub {
 
 BufferPoolManagerInstance::BufferPoolManagerInstance(size_t pool_size, DiskManager *disk_manager,
-                                                     LogManager *log_manager)
-    : BufferPoolManagerInstance(pool_size, 1, 0, disk_manager, log_manager) {}
+                                                     LogManager *log_manager, ReplacerType replacer_type,
+                                                     size_t max_pool_size)
+    : BufferPoolManagerInstance(pool_size, 1, 0, disk_manager, log_manager, replacer_type, max_pool_size) {}
 
 BufferPoolManagerInstance::BufferPoolManagerInstance(size_t pool_size, uint32_t num_instances, uint32_t instance_index,
-                                                     DiskManager *disk_manager, LogManager *log_manager)
+                                                     DiskManager *disk_manager, LogManager *log_manager,
+                                                     ReplacerType replacer_type, size_t max_pool_size,
+                                                     int numa_node)
     : pool_size_(pool_size),
+      max_pool_size_(std::max(pool_size, max_pool_size)),
       num_instances_(num_instances),
       instance_index_(instance_index),
-      next_page_id_(instance_index),
+      numa_node_(numa_node),
       disk_manager_(disk_manager),
       log_manager_(log_manager) {
   BUSTUB_ASSERT(num_instances > 0, "If BPI is not part of a pool, then the pool size should just be 1");
   BUSTUB_ASSERT(
       instance_index < num_instances,
       "BPI index cannot be greater than the number of BPIs in the pool. In non-parallel case, index should just be 1.");
-  // We allocate a consecutive memory space for the buffer pool.
-  pages_ = new Page[pool_size_];
-  replacer_ = new LRUReplacer(pool_size);
+  // We allocate a consecutive memory space for the buffer pool. The frame data goes into one aligned arena, apart from
+  // the book-keeping of the frames. There is room for max_pool_size_ frames, so that frames never move. Both are fresh
+  // mappings of whole pages, which lets them be placed on the NUMA node before they are touched.
+  frame_arena_ = new FrameArena(pool_size_, max_pool_size_, numa_node_);
+  void *pages = mmap(nullptr, PagesSize(), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (pages == MAP_FAILED) {
+    delete frame_arena_;
+    throw std::bad_alloc();
+  }
+  pages_ = static_cast<Page *>(pages);
+  if (numa_node_ >= 0) {
+    NumaUtil::BindMemory(pages_, PagesSize(), numa_node_);
+  }
+  for (size_t i = 0; i < max_pool_size_; ++i) {
+    new (&pages_[i]) Page(frame_arena_->GetFrameData(i));
+  }
+  switch (replacer_type) {
+    case ReplacerType::LRU_K:
+      replacer_ = new LRUKReplacer(max_pool_size_);
+      break;
+    case ReplacerType::CLOCK:
+      replacer_ = new ClockReplacer(max_pool_size_);
+      break;
+    case ReplacerType::ARC:
+      replacer_ = new ARCReplacer(max_pool_size_);
+      break;
+    case ReplacerType::LRU:
+    default:
+      replacer_ = new LRUReplacer(max_pool_size_);
+      break;
+  }
 
   // Initially, every page is in the free list.
   for (size_t i = 0; i < pool_size_; ++i) {
     free_list_.emplace_back(static_cast<int>(i));
   }
+
+  if (compressed_page_cache_size > 0) {
+    compressed_cache_ = new CompressedPageCache(compressed_page_cache_size);
+  }
+
+  // The free page map sits next to the database file, one per instance: test.db keeps the one of instance 0 in
+  // test.fsm0. Only a database with pages in its data files has page ids in use.
+  const std::string &db_file_name = disk_manager_->GetFileName();
+  const std::string stem = db_file_name.substr(0, db_file_name.rfind('.'));
+  free_page_map_ = new FreePageMap(stem + ".fsm" + std::to_string(instance_index_), num_instances_, instance_index_,
+                                   disk_manager_->GetNumPages());
+
+  // Dumps sit next to it the same way, test.db keeps the pages of instance 0 in test.pool0.
+  dump_file_name_ = stem + ".pool" + std::to_string(instance_index_);
+  last_dump_ = std::chrono::steady_clock::now();
+  if (enable_buffer_pool_dump) {
+    std::vector<DumpEntry> entries;
+    if (ReadDump(&entries)) {
+      warm_up_thread_ = new std::thread(&BufferPoolManagerInstance::WarmUp, this, std::move(entries));
+    }
+  }
+
+  bg_writer_thread_ = new std::thread(&BufferPoolManagerInstance::BackgroundWriterLoop, this);
 }
 
 BufferPoolManagerInstance::~BufferPoolManagerInstance() {
-  delete[] pages_;
+  if (warm_up_thread_ != nullptr) {
+    stop_warm_up_ = true;
+    warm_up_thread_->join();
+    delete warm_up_thread_;
+  }
+  {
+    std::scoped_lock lock(prefetch_latch_);
+    stop_prefetch_ = true;
+  }
+  prefetch_cv_.notify_one();
+  if (prefetch_thread_ != nullptr) {
+    prefetch_thread_->join();
+    delete prefetch_thread_;
+  }
+  {
+    std::scoped_lock lock(bg_writer_latch_);
+    stop_bg_writer_ = true;
+  }
+  bg_writer_cv_.notify_one();
+  bg_writer_thread_->join();
+  delete bg_writer_thread_;
+  if (enable_buffer_pool_dump) {
+    DumpResidentPages();
+  }
+  for (size_t i = 0; i < max_pool_size_; ++i) {
+    pages_[i].~Page();
+  }
+  munmap(pages_, PagesSize());
+  delete frame_arena_;
+  delete compressed_cache_;
   delete replacer_;
+  delete free_page_map_;
 }
 
 bool BufferPoolManagerInstance::FlushPgImp(page_id_t page_id) {
-  // Make sure you call DiskManager::WritePage!
-  return false;
+  if (page_id == INVALID_PAGE_ID) {
+    return false;
+  }
+  std::scoped_lock lock(latch_);
+  auto &stripe = StripeOf(page_id);
+  std::scoped_lock stripe_lock(stripe.latch_);
+  auto it = stripe.table_.find(page_id);
+  if (it == stripe.table_.end()) {
+    return false;
+  }
+  Page *page = &pages_[it->second];
+  FlushLogFor(page);
+  disk_manager_->WritePage(page_id, page->GetData());
+  page->is_dirty_ = false;
+  return true;
 }
 
-void BufferPoolManagerInstance::FlushAllPgsImp() {
-  // You can do it!
+void BufferPoolManagerInstance::FlushAllPgsImp() { FlushInstances({this}); }
+
+void BufferPoolManagerInstance::FlushInstances(const std::vector<BufferPoolManagerInstance *> &instances) {
+  if (instances.empty()) {
+    return;
+  }
+  struct DirtyPage {
+    page_id_t page_id_;
+    BufferPoolManagerInstance *instance_;
+    frame_id_t frame_id_;
+  };
+  std::vector<DirtyPage> dirty_pages;
+  for (auto *instance : instances) {
+    for (auto &stripe : instance->page_table_) {
+      std::scoped_lock stripe_lock(stripe.latch_);
+      for (const auto &[page_id, frame_id] : stripe.table_) {
+        Page *page = &instance->pages_[frame_id];
+        if (page->is_dirty_) {
+          // The pin keeps the page in its frame until it is written, while misses go on evicting other pages.
+          instance->PinQuietly(page);
+          // Clear the flag before writing, a writer that has the page pinned re-dirties it when unpinning.
+          page->is_dirty_ = false;
+          dirty_pages.push_back({page_id, instance, frame_id});
+        }
+      }
+    }
+  }
+  std::sort(dirty_pages.begin(), dirty_pages.end(),
+            [](const DirtyPage &a, const DirtyPage &b) { return a.page_id_ < b.page_id_; });
+  std::vector<page_id_t> page_ids;
+  std::vector<const char *> page_data;
+  page_ids.reserve(dirty_pages.size());
+  page_data.reserve(dirty_pages.size());
+  lsn_t max_lsn = INVALID_LSN;
+  for (const auto &dirty_page : dirty_pages) {
+    Page *page = &dirty_page.instance_->pages_[dirty_page.frame_id_];
+    page_ids.push_back(dirty_page.page_id_);
+    page_data.push_back(page->GetData());
+    max_lsn = std::max(max_lsn, dirty_page.instance_->UnloggedLSN(page));
+  }
+  // One log flush covers the whole batch.
+  if (max_lsn != INVALID_LSN) {
+    instances.front()->log_manager_->FlushTo(max_lsn);
+  }
+  instances.front()->disk_manager_->WritePages(page_ids, page_data.data());
+  for (const auto &dirty_page : dirty_pages) {
+    dirty_page.instance_->UnpinQuietly(dirty_page.page_id_, dirty_page.frame_id_);
+  }
+  for (auto *instance : instances) {
+    instance->free_page_map_->Sync();
+  }
 }
 
 Page *BufferPoolManagerInstance::NewPgImp(page_id_t *page_id) {
-  // 0.   Make sure you call AllocatePage!
-  // 1.   If all the pages in the buffer pool are pinned, return nullptr.
-  // 2.   Pick a victim page P from either the free list or the replacer. Always pick from the free list first.
-  // 3.   Update P's metadata, zero out memory and add P to the page table.
-  // 4.   Set the page ID output parameter. Return a pointer to P.
-  return nullptr;
+  return NewPgNearImp(page_id, INVALID_PAGE_ID, nullptr);
+}
+
+Page *BufferPoolManagerInstance::NewPgWithStrategyImp(page_id_t *page_id, BufferAccessStrategy *strategy) {
+  return NewPgNearImp(page_id, INVALID_PAGE_ID, strategy);
+}
+
+Page *BufferPoolManagerInstance::NewPgNearImp(page_id_t *page_id, page_id_t hint, BufferAccessStrategy *strategy) {
+  std::scoped_lock lock(latch_);
+  BufferRing *ring = strategy == nullptr ? nullptr : GetRing(strategy->GetId(), strategy->GetType());
+  frame_id_t frame_id;
+  if (!FindVictimFrame(ring, &frame_id)) {
+    stats_.AddPinWait();
+    return nullptr;
+  }
+  // Only allocate once we know there is room, so that a full pool does not burn page ids.
+  *page_id = AllocatePage(hint);
+  Page *page = &pages_[frame_id];
+  page->ResetMemory();
+  page->page_id_ = *page_id;
+  page->pin_count_ = 1;
+  num_pinned_frames_.fetch_add(1, std::memory_order_relaxed);
+  page->is_dirty_ = false;
+  auto &stripe = StripeOf(*page_id);
+  std::scoped_lock stripe_lock(stripe.latch_);
+  stripe.table_.emplace(*page_id, frame_id);
+  replacer_->AssignPage(frame_id, *page_id);
+  replacer_->Pin(frame_id);
+  AddToRing(ring, frame_id, *page_id);
+  return page;
+}
+
+Page *BufferPoolManagerInstance::FetchPgImp(page_id_t page_id) { return FetchPgWithStrategyImp(page_id, nullptr); }
+
+Page *BufferPoolManagerInstance::FetchPgWithStrategyImp(page_id_t page_id, BufferAccessStrategy *strategy) {
+  Page *page = PinIfResident(page_id);
+  if (page != nullptr) {
+    stats_.AddHit();
+    return page;
+  }
+
+  // The latency of a miss includes waiting for the latch and writing back the victim.
+  const auto start = std::chrono::steady_clock::now();
+  std::scoped_lock lock(latch_);
+  // Someone else may have brought the page in while we were waiting for the latch.
+  page = PinIfResident(page_id);
+  if (page != nullptr) {
+    stats_.AddHit();
+    return page;
+  }
+  BufferRing *ring = strategy == nullptr ? nullptr : GetRing(strategy->GetId(), strategy->GetType());
+  frame_id_t frame_id;
+  if (!FindVictimFrame(ring, &frame_id)) {
+    stats_.AddPinWait();
+    return nullptr;
+  }
+  page = &pages_[frame_id];
+  page->page_id_ = page_id;
+  page->pin_count_ = 1;
+  num_pinned_frames_.fetch_add(1, std::memory_order_relaxed);
+  page->is_dirty_ = false;
+  try {
+    ReadPage(page_id, page->GetData());
+  } catch (const CorruptionException &) {
+    DiscardFrame(frame_id);
+    throw;
+  }
+  stats_.AddMiss(std::chrono::steady_clock::now() - start);
+  // Publish the page only once its contents are in place, the hit path does not wait for the read.
+  auto &stripe = StripeOf(page_id);
+  std::scoped_lock stripe_lock(stripe.latch_);
+  stripe.table_.emplace(page_id, frame_id);
+  replacer_->AssignPage(frame_id, page_id);
+  replacer_->Pin(frame_id);
+  AddToRing(ring, frame_id, page_id);
+  return page;
+}
+
+Page *BufferPoolManagerInstance::FetchPgSwizzledImp(Swip *swip) {
+  frame_id_t frame_id;
+  uint32_t generation;
+  if (swip->GetFrame(&frame_id, &generation)) {
+    Page *page = PinIfInFrame(swip->GetPageId(), frame_id, generation);
+    if (page != nullptr) {
+      stats_.AddHit();
+      return page;
+    }
+  }
+  Page *page = FetchPgImp(swip->GetPageId());
+  if (page == nullptr) {
+    swip->Unswizzle();
+    return nullptr;
+  }
+  // The page is pinned, so it cannot leave the frame and bump the generation under us.
+  swip->Swizzle(static_cast<frame_id_t>(page - pages_), page->generation_);
+  return page;
 }
 
-Page *BufferPoolManagerInstance::FetchPgImp(page_id_t page_id) {
-  // 1.     Search the page table for the requested page (P).
-  // 1.1    If P exists, pin it and return it immediately.
-  // 1.2    If P does not exist, find a replacement page (R) from either the free list or the replacer.
-  //        Note that pages are always found from the free list first.
-  // 2.     If R is dirty, write it back to the disk.
-  // 3.     Delete R from the page table and insert P.
-  // 4.     Update P's metadata, read in the page content from disk, and then return a pointer to P.
-  return nullptr;
+bool BufferPoolManagerInstance::FetchPgsImp(const std::vector<page_id_t> &page_ids, Page **pages) {
+  std::vector<size_t> misses;
+  for (size_t i = 0; i < page_ids.size(); ++i) {
+    pages[i] = PinIfResident(page_ids[i]);
+    if (pages[i] == nullptr) {
+      misses.push_back(i);
+    } else {
+      stats_.AddHit();
+    }
+  }
+  if (misses.empty()) {
+    return true;
+  }
+
+  std::scoped_lock lock(latch_);
+  bool fetched_all = true;
+  // Frames taken for the misses, by page id. They are published only after the batch is read.
+  std::unordered_map<page_id_t, frame_id_t> loading;
+  for (size_t i : misses) {
+    const page_id_t page_id = page_ids[i];
+    auto it = loading.find(page_id);
+    if (it != loading.end()) {
+      // Asked for twice in the batch. Nobody else can see the page yet, so the pin count is ours alone.
+      pages[i] = &pages_[it->second];
+      ++pages[i]->pin_count_;
+      stats_.AddHit();
+      continue;
+    }
+    // Someone else may have brought the page in while we were waiting for the latch.
+    pages[i] = PinIfResident(page_id);
+    if (pages[i] != nullptr) {
+      stats_.AddHit();
+      continue;
+    }
+    frame_id_t frame_id;
+    if (!FindVictimFrame(&frame_id)) {
+      stats_.AddPinWait();
+      fetched_all = false;
+      continue;
+    }
+    pages[i] = &pages_[frame_id];
+    pages[i]->page_id_ = page_id;
+    pages[i]->pin_count_ = 1;
+    num_pinned_frames_.fetch_add(1, std::memory_order_relaxed);
+    pages[i]->is_dirty_ = false;
+    loading.emplace(page_id, frame_id);
+  }
+
+  std::vector<std::pair<page_id_t, frame_id_t>> reads(loading.begin(), loading.end());
+  std::sort(reads.begin(), reads.end());
+  std::vector<page_id_t> read_ids;
+  std::vector<char *> read_data;
+  read_ids.reserve(reads.size());
+  read_data.reserve(reads.size());
+  for (const auto &[page_id, frame_id] : reads) {
+    stats_.AddMiss();
+    if (compressed_cache_ != nullptr && compressed_cache_->Take(page_id, pages_[frame_id].GetData())) {
+      continue;
+    }
+    read_ids.push_back(page_id);
+    read_data.push_back(pages_[frame_id].GetData());
+  }
+  if (!read_ids.empty()) {
+    try {
+      disk_manager_->ReadPages(read_ids, read_data.data());
+    } catch (const CorruptionException &) {
+      // Give back every pin the batch took, the caller gets no pages.
+      for (size_t i = 0; i < page_ids.size(); ++i) {
+        if (pages[i] != nullptr && loading.count(page_ids[i]) == 0) {
+          UnpinPgImp(page_ids[i], false);
+        }
+        pages[i] = nullptr;
+      }
+      for (const auto &[page_id, frame_id] : reads) {
+        DiscardFrame(frame_id);
+      }
+      throw;
+    }
+  }
+  for (const auto &[page_id, frame_id] : reads) {
+    auto &stripe = StripeOf(page_id);
+    std::scoped_lock stripe_lock(stripe.latch_);
+    stripe.table_.emplace(page_id, frame_id);
+    replacer_->AssignPage(frame_id, page_id);
+    replacer_->Pin(frame_id);
+  }
+  return fetched_all;
 }
 
 bool BufferPoolManagerInstance::DeletePgImp(page_id_t page_id) {
-  // 0.   Make sure you call DeallocatePage!
-  // 1.   Search the page table for the requested page (P).
-  // 1.   If P does not exist, return true.
-  // 2.   If P exists, but has a non-zero pin-count, return false. Someone is using the page.
-  // 3.   Otherwise, P can be deleted. Remove P from the page table, reset its metadata and return it to the free list.
+  std::scoped_lock lock(latch_);
+  auto &stripe = StripeOf(page_id);
+  frame_id_t frame_id;
+  {
+    std::scoped_lock stripe_lock(stripe.latch_);
+    auto it = stripe.table_.find(page_id);
+    if (it == stripe.table_.end()) {
+      if (compressed_cache_ != nullptr) {
+        compressed_cache_->Remove(page_id);
+      }
+      DeallocatePage(page_id);
+      return true;
+    }
+    frame_id = it->second;
+    if (pages_[frame_id].pin_count_ > 0) {
+      return false;
+    }
+    stripe.table_.erase(it);
+    ++pages_[frame_id].generation_;
+  }
+  Page *page = &pages_[frame_id];
+  replacer_->Remove(frame_id);
+  page->ResetMemory();
+  page->page_id_ = INVALID_PAGE_ID;
+  page->is_dirty_ = false;
+  if (static_cast<size_t>(frame_id) < pool_size_) {
+    free_list_.push_back(frame_id);
+  }
+  DeallocatePage(page_id);
+  return true;
+}
+
+bool BufferPoolManagerInstance::UnpinPgImp(page_id_t page_id, bool is_dirty) {
+  auto &stripe = StripeOf(page_id);
+  std::scoped_lock stripe_lock(stripe.latch_);
+  auto it = stripe.table_.find(page_id);
+  if (it == stripe.table_.end()) {
+    return false;
+  }
+  Page *page = &pages_[it->second];
+  if (page->pin_count_ <= 0) {
+    return false;
+  }
+  if (is_dirty) {
+    page->is_dirty_ = true;
+  }
+  if (page->pin_count_.fetch_sub(1) == 1) {
+    num_pinned_frames_.fetch_sub(1, std::memory_order_relaxed);
+    QueueAccess(&stripe, it->second, false);
+  }
+  return true;
+}
+
+bool BufferPoolManagerInstance::ResizePool(size_t pool_size) {
+  if (pool_size == 0 || pool_size > max_pool_size_) {
+    return false;
+  }
+  std::scoped_lock resize_lock(resize_latch_);
+  const size_t old_pool_size = pool_size_;
+  if (pool_size >= old_pool_size) {
+    std::scoped_lock lock(latch_);
+    if (!frame_arena_->Resize(pool_size)) {
+      return false;
+    }
+    for (size_t i = old_pool_size; i < pool_size; ++i) {
+      free_list_.emplace_back(static_cast<frame_id_t>(i));
+    }
+    pool_size_ = pool_size;
+    return true;
+  }
+
+  {
+    std::scoped_lock lock(latch_);
+    pool_size_ = pool_size;
+    free_list_.remove_if([&](frame_id_t frame_id) { return static_cast<size_t>(frame_id) >= pool_size; });
+  }
+  // Empty the dropped frames a round at a time, so that misses and evictions go on in between.
+  const auto deadline = std::chrono::steady_clock::now() + buffer_pool_resize_timeout;
+  while (true) {
+    {
+      std::scoped_lock lock(latch_);
+      if (DrainFrames(pool_size, old_pool_size)) {
+        frame_arena_->Resize(pool_size);
+        return true;
+      }
+      if (std::chrono::steady_clock::now() >= deadline) {
+        // Some pages are still in use. Take the frames back, the drained ones are free.
+        for (size_t i = pool_size; i < old_pool_size; ++i) {
+          if (pages_[i].page_id_ == INVALID_PAGE_ID) {
+            free_list_.emplace_back(static_cast<frame_id_t>(i));
+          }
+        }
+        pool_size_ = old_pool_size;
+        return false;
+      }
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+}
+
+size_t BufferPoolManagerInstance::GetNumAvailableFrames() const {
+  // Both values may be changing, a shrink can leave pinned pages past the end of the pool for a while.
+  const size_t pool_size = pool_size_.load(std::memory_order_relaxed);
+  const size_t num_pinned = num_pinned_frames_.load(std::memory_order_relaxed);
+  return num_pinned < pool_size ? pool_size - num_pinned : 0;
+}
+
+BufferPoolStatsSnapshot BufferPoolManagerInstance::GetStats() {
+  BufferPoolStatsSnapshot snapshot = stats_.GetSnapshot();
+  if (compressed_cache_ != nullptr) {
+    snapshot.compressed_hits_ = compressed_cache_->GetHits();
+    snapshot.compressed_misses_ = compressed_cache_->GetMisses();
+    snapshot.compressed_bytes_ = compressed_cache_->GetMemoryUsed();
+  }
+  return snapshot;
+}
+
+bool BufferPoolManagerInstance::IsResident(page_id_t page_id) {
+  auto &stripe = StripeOf(page_id);
+  std::scoped_lock stripe_lock(stripe.latch_);
+  return stripe.table_.count(page_id) != 0;
+}
+
+bool BufferPoolManagerInstance::PeekResidentPage(page_id_t page_id, const std::function<void(Page *)> &reader) {
+  auto &stripe = StripeOf(page_id);
+  frame_id_t frame_id;
+  Page *page;
+  {
+    std::scoped_lock stripe_lock(stripe.latch_);
+    auto it = stripe.table_.find(page_id);
+    if (it == stripe.table_.end()) {
+      return false;
+    }
+    frame_id = it->second;
+    page = &pages_[frame_id];
+    PinQuietly(page);
+  }
+  reader(page);
+  UnpinQuietly(page_id, frame_id);
+  return true;
+}
+
+void BufferPoolManagerInstance::ReleaseAccessStrategy(uint64_t strategy_id) {
+  {
+    std::unique_lock lock(prefetch_latch_);
+    prefetch_queue_.erase(std::remove_if(prefetch_queue_.begin(), prefetch_queue_.end(),
+                                         [&](const PrefetchRequest &request) {
+                                           return request.strategy_id_ == strategy_id;
+                                         }),
+                          prefetch_queue_.end());
+    // A load that is already under way would bring the ring back to life after we dropped it.
+    prefetch_done_cv_.wait(lock, [&] { return prefetch_loading_strategy_ != strategy_id; });
+  }
+  std::scoped_lock lock(latch_);
+  rings_.erase(strategy_id);
+}
+
+void BufferPoolManagerInstance::PrefetchPgImp(page_id_t page_id, BufferAccessStrategy *strategy) {
+  if (page_id == INVALID_PAGE_ID || IsResident(page_id)) {
+    return;
+  }
+  {
+    std::scoped_lock lock(prefetch_latch_);
+    if (stop_prefetch_ || prefetch_queue_.size() >= PREFETCH_QUEUE_SIZE ||
+        std::any_of(prefetch_queue_.begin(), prefetch_queue_.end(),
+                    [&](const PrefetchRequest &request) { return request.page_id_ == page_id; })) {
+      return;
+    }
+    if (strategy == nullptr) {
+      prefetch_queue_.push_back({page_id, 0, BufferAccessStrategyType::BULK_READ});
+    } else {
+      prefetch_queue_.push_back({page_id, strategy->GetId(), strategy->GetType()});
+    }
+    if (prefetch_thread_ == nullptr) {
+      prefetch_thread_ = new std::thread(&BufferPoolManagerInstance::PrefetchLoop, this);
+    }
+  }
+  prefetch_cv_.notify_one();
+}
+
+void BufferPoolManagerInstance::PrefetchLoop() {
+  std::unique_lock lock(prefetch_latch_);
+  while (true) {
+    prefetch_cv_.wait(lock, [&] { return stop_prefetch_ || !prefetch_queue_.empty(); });
+    if (stop_prefetch_) {
+      return;
+    }
+    PrefetchRequest request = prefetch_queue_.front();
+    prefetch_queue_.pop_front();
+    prefetch_loading_strategy_ = request.strategy_id_;
+    lock.unlock();
+    LoadPage(request);
+    lock.lock();
+    prefetch_loading_strategy_ = 0;
+    prefetch_done_cv_.notify_all();
+  }
+}
+
+bool BufferPoolManagerInstance::LoadPage(const PrefetchRequest &request, bool free_frame_only) {
+  const page_id_t page_id = request.page_id_;
+  std::scoped_lock lock(latch_);
+  if (IsResident(page_id)) {
+    return true;
+  }
+  if (free_frame_only && free_list_.empty()) {
+    return false;
+  }
+  BufferRing *ring = GetRing(request.strategy_id_, request.strategy_type_);
+  frame_id_t frame_id;
+  if (!FindVictimFrame(ring, &frame_id)) {
+    return false;
+  }
+  Page *page = &pages_[frame_id];
+  page->page_id_ = page_id;
+  page->pin_count_ = 0;
+  page->is_dirty_ = false;
+  try {
+    ReadPage(page_id, page->GetData());
+  } catch (const CorruptionException &) {
+    // a background load has nobody to report to, the page fails again when it is fetched
+    LOG_DEBUG("prefetched page %d is corrupt", page_id);
+    DiscardFrame(frame_id);
+    return false;
+  }
+  auto &stripe = StripeOf(page_id);
+  std::scoped_lock stripe_lock(stripe.latch_);
+  stripe.table_.emplace(page_id, frame_id);
+  replacer_->AssignPage(frame_id, page_id);
+  replacer_->Unpin(frame_id);
+  AddToRing(ring, frame_id, page_id);
+  return true;
+}
+
+void BufferPoolManagerInstance::DumpResidentPages() {
+  std::vector<DumpEntry> entries;
+  {
+    std::scoped_lock lock(latch_);
+    // The replacer knows how hot the unpinned pages are, coldest first. Pinned pages are in use, so hottest of all.
+    std::vector<frame_id_t> victims;
+    ApplyAllAccesses();
+    replacer_->PeekVictims(pool_size_, &victims);
+    std::unordered_map<frame_id_t, uint32_t> ranks;
+    for (size_t i = 0; i < victims.size(); ++i) {
+      ranks.emplace(victims[i], static_cast<uint32_t>(i + 1));
+    }
+    for (size_t i = 0; i < pool_size_; ++i) {
+      const page_id_t page_id = pages_[i].page_id_;
+      if (page_id == INVALID_PAGE_ID) {
+        continue;
+      }
+      auto it = ranks.find(static_cast<frame_id_t>(i));
+      entries.emplace_back(page_id, it == ranks.end() ? static_cast<uint32_t>(victims.size() + 1) : it->second);
+    }
+  }
+
+  const auto count = static_cast<uint32_t>(entries.size());
+  std::string data;
+  data.reserve(sizeof(DUMP_MAGIC) + sizeof(count) + entries.size() * (sizeof(page_id_t) + sizeof(uint32_t)));
+  data.append(reinterpret_cast<const char *>(&DUMP_MAGIC), sizeof(DUMP_MAGIC));
+  data.append(reinterpret_cast<const char *>(&count), sizeof(count));
+  for (const auto &[page_id, hotness] : entries) {
+    data.append(reinterpret_cast<const char *>(&page_id), sizeof(page_id));
+    data.append(reinterpret_cast<const char *>(&hotness), sizeof(hotness));
+  }
+  // A crash leaves either the previous dump or this one behind, never a torn one.
+  std::scoped_lock dump_lock(dump_latch_);
+  if (!FileUtil::ReplaceFile(dump_file_name_, data)) {
+    LOG_DEBUG("failed to write buffer pool dump");
+  }
+}
+
+bool BufferPoolManagerInstance::ReadDump(std::vector<DumpEntry> *entries) {
+  std::ifstream in(dump_file_name_, std::ios::binary);
+  uint32_t magic = 0;
+  uint32_t count = 0;
+  in.read(reinterpret_cast<char *>(&magic), sizeof(magic));
+  in.read(reinterpret_cast<char *>(&count), sizeof(count));
+  if (!in || magic != DUMP_MAGIC) {
+    return false;
+  }
+  for (uint32_t i = 0; i < count; ++i) {
+    page_id_t page_id;
+    uint32_t hotness;
+    in.read(reinterpret_cast<char *>(&page_id), sizeof(page_id));
+    in.read(reinterpret_cast<char *>(&hotness), sizeof(hotness));
+    if (!in) {
+      return false;
+    }
+    // The dump may come from a pool with a different number of instances.
+    if (page_id >= 0 && static_cast<uint32_t>(page_id) % num_instances_ == instance_index_) {
+      entries->emplace_back(page_id, hotness);
+    }
+  }
+  return !entries->empty();
+}
+
+void BufferPoolManagerInstance::WarmUp(std::vector<DumpEntry> entries) {
+  // Keep the hottest pages that fit, then read them in page id order.
+  std::sort(entries.begin(), entries.end(), [](const DumpEntry &a, const DumpEntry &b) { return a.second > b.second; });
+  if (entries.size() > pool_size_) {
+    entries.resize(pool_size_);
+  }
+  std::vector<DumpEntry> by_page_id = entries;
+  std::sort(by_page_id.begin(), by_page_id.end());
+  for (const auto &[page_id, hotness] : by_page_id) {
+    if (stop_warm_up_ || !LoadPage({page_id, 0, BufferAccessStrategyType::BULK_READ}, true)) {
+      break;
+    }
+  }
+
+  // Loading left the pages in page id order in the replacer. Touch them from coldest to hottest to restore the order
+  // they had, leaving alone whatever traffic is using already.
+  std::scoped_lock lock(latch_);
+  for (auto it = entries.rbegin(); it != entries.rend(); ++it) {
+    auto &stripe = StripeOf(it->first);
+    std::scoped_lock stripe_lock(stripe.latch_);
+    auto entry = stripe.table_.find(it->first);
+    if (entry != stripe.table_.end() && pages_[entry->second].pin_count_ == 0) {
+      replacer_->Pin(entry->second);
+      replacer_->Unpin(entry->second);
+    }
+  }
+}
+
+BufferPoolManagerInstance::BufferRing *BufferPoolManagerInstance::GetRing(uint64_t strategy_id,
+                                                                          BufferAccessStrategyType type) {
+  if (strategy_id == 0) {
+    return nullptr;
+  }
+  auto it = rings_.find(strategy_id);
+  if (it == rings_.end()) {
+    // Never let a ring take more than an eighth of the instance, small pools would otherwise be all ring. It still
+    // has to hold the page being read and the read-ahead window behind it, or prefetches recycle each other.
+    const size_t ring_size = type == BufferAccessStrategyType::BULK_WRITE ? BULK_WRITE_RING_SIZE : BULK_READ_RING_SIZE;
+    const size_t pool_size = pool_size_;
+    const size_t min_ring_size = std::min(pool_size, read_ahead_window + 1);
+    BufferRing ring{type, std::max({size_t{1}, min_ring_size, std::min(ring_size, pool_size / 8)}), {}, 0};
+    it = rings_.emplace(strategy_id, std::move(ring)).first;
+  }
+  return &it->second;
+}
+
+void BufferPoolManagerInstance::AddToRing(BufferRing *ring, frame_id_t frame_id, page_id_t page_id) {
+  if (ring == nullptr) {
+    return;
+  }
+  if (ring->slots_.size() < ring->size_) {
+    ring->slots_.emplace_back(frame_id, page_id);
+    return;
+  }
+  ring->slots_[ring->next_] = {frame_id, page_id};
+  ring->next_ = (ring->next_ + 1) % ring->size_;
+}
+
+void BufferPoolManagerInstance::BackgroundWriterLoop() {
+  std::unique_lock lock(bg_writer_latch_);
+  while (!stop_bg_writer_) {
+    bg_writer_cv_.wait_for(lock, background_writer_interval);
+    if (stop_bg_writer_) {
+      return;
+    }
+    lock.unlock();
+    CleanVictimFrames(background_writer_max_pages);
+    if (enable_buffer_pool_dump && std::chrono::steady_clock::now() - last_dump_ >= buffer_pool_dump_interval) {
+      DumpResidentPages();
+      last_dump_ = std::chrono::steady_clock::now();
+    }
+    lock.lock();
+  }
+}
+
+size_t BufferPoolManagerInstance::CleanVictimFrames(size_t max_frames) {
+  std::vector<std::pair<page_id_t, frame_id_t>> dirty_pages;
+  {
+    std::scoped_lock lock(latch_);
+    std::vector<frame_id_t> frame_ids;
+    ApplyAllAccesses();
+    replacer_->PeekVictims(max_frames, &frame_ids);
+    for (auto frame_id : frame_ids) {
+      Page *page = &pages_[frame_id];
+      if (page->is_dirty_ && page->pin_count_ == 0) {
+        dirty_pages.emplace_back(page->page_id_, frame_id);
+      }
+    }
+  }
+  std::sort(dirty_pages.begin(), dirty_pages.end());
+
+  size_t num_written = 0;
+  for (const auto &[page_id, frame_id] : dirty_pages) {
+    // Take the latch once per page, so that misses can get in between writes. Holding it keeps the frame from being
+    // evicted under us, but the page may have changed hands or been pinned since we looked.
+    std::scoped_lock lock(latch_);
+    Page *page = &pages_[frame_id];
+    {
+      auto &stripe = StripeOf(page_id);
+      std::scoped_lock stripe_lock(stripe.latch_);
+      if (page->page_id_ != page_id || page->pin_count_ > 0 || !page->is_dirty_ || UnloggedLSN(page) != INVALID_LSN) {
+        continue;
+      }
+      // Clear the flag before writing, a writer that pins the page from now on re-dirties it when unpinning.
+      page->is_dirty_ = false;
+    }
+    disk_manager_->WritePage(page_id, page->GetData());
+    stats_.AddBackgroundWrite();
+    num_written++;
+  }
+  return num_written;
+}
+
+Page *BufferPoolManagerInstance::PinIfResident(page_id_t page_id) {
+  auto &stripe = StripeOf(page_id);
+  std::scoped_lock stripe_lock(stripe.latch_);
+  auto it = stripe.table_.find(page_id);
+  if (it == stripe.table_.end()) {
+    return nullptr;
+  }
+  Page *page = &pages_[it->second];
+  // Only the first pin counts as an access, concurrent readers of a hot page skip the replacer entirely.
+  if (page->pin_count_.fetch_add(1) == 0) {
+    num_pinned_frames_.fetch_add(1, std::memory_order_relaxed);
+    QueueAccess(&stripe, it->second, true);
+  }
+  return page;
+}
+
+Page *BufferPoolManagerInstance::PinIfInFrame(page_id_t page_id, frame_id_t frame_id, uint32_t generation) {
+  if (static_cast<size_t>(frame_id) >= max_pool_size_) {
+    return nullptr;
+  }
+  // Pages leave their frame under the stripe latch of their id, so the generation cannot change while we hold it.
+  auto &stripe = StripeOf(page_id);
+  std::scoped_lock stripe_lock(stripe.latch_);
+  Page *page = &pages_[frame_id];
+  if (page->generation_ != generation) {
+    return nullptr;
+  }
+  if (page->pin_count_.fetch_add(1) == 0) {
+    num_pinned_frames_.fetch_add(1, std::memory_order_relaxed);
+    QueueAccess(&stripe, frame_id, true);
+  }
+  return page;
+}
+
+void BufferPoolManagerInstance::PinQuietly(Page *page) {
+  // Eviction skips pinned pages whatever the replacer says.
+  if (page->pin_count_.fetch_add(1) == 0) {
+    num_pinned_frames_.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+void BufferPoolManagerInstance::UnpinQuietly(page_id_t page_id, frame_id_t frame_id) {
+  auto &stripe = StripeOf(page_id);
+  std::scoped_lock stripe_lock(stripe.latch_);
+  if (pages_[frame_id].pin_count_.fetch_sub(1) == 1) {
+    num_pinned_frames_.fetch_sub(1, std::memory_order_relaxed);
+    // Eviction may have skipped the frame meanwhile and dropped it from the replacer, this puts it back.
+    QueueAccess(&stripe, frame_id, false);
+  }
+}
+
+void BufferPoolManagerInstance::QueueAccess(PageTableStripe *stripe, frame_id_t frame_id, bool pinned) {
+  stripe->accesses_.push_back({next_access_seq_.fetch_add(1, std::memory_order_relaxed), frame_id,
+                               pages_[frame_id].generation_.load(), pinned});
+  if (stripe->accesses_.size() >= MAX_QUEUED_ACCESSES) {
+    ApplyAccesses(stripe->accesses_);
+    stripe->accesses_.clear();
+  }
+}
+
+void BufferPoolManagerInstance::ApplyAccesses(const std::vector<QueuedAccess> &accesses) {
+  for (const auto &access : accesses) {
+    // The page may have left the frame since, its history went with it.
+    if (pages_[access.frame_id_].generation_ != access.generation_) {
+      continue;
+    }
+    if (access.pinned_) {
+      replacer_->Pin(access.frame_id_);
+    } else {
+      replacer_->Unpin(access.frame_id_);
+    }
+  }
+}
+
+void BufferPoolManagerInstance::ApplyAllAccesses() {
+  // Hold every stripe so that the transitions of all of them go to the replacer in the order they happened.
+  std::vector<std::unique_lock<std::mutex>> stripe_locks;
+  stripe_locks.reserve(PAGE_TABLE_STRIPES);
+  std::vector<QueuedAccess> accesses;
+  for (auto &stripe : page_table_) {
+    stripe_locks.emplace_back(stripe.latch_);
+    accesses.insert(accesses.end(), stripe.accesses_.begin(), stripe.accesses_.end());
+    stripe.accesses_.clear();
+  }
+  std::sort(accesses.begin(), accesses.end(),
+            [](const QueuedAccess &a, const QueuedAccess &b) { return a.seq_ < b.seq_; });
+  ApplyAccesses(accesses);
+}
+
+bool BufferPoolManagerInstance::FindVictimFrame(frame_id_t *frame_id) {
+  if (!free_list_.empty()) {
+    *frame_id = free_list_.front();
+    free_list_.pop_front();
+    return true;
+  }
+  ApplyAllAccesses();
+  while (replacer_->Victim(frame_id)) {
+    Page *victim = &pages_[*frame_id];
+    auto &stripe = StripeOf(victim->page_id_);
+    {
+      std::scoped_lock stripe_lock(stripe.latch_);
+      if (victim->pin_count_ > 0) {
+        // A hit pinned the page after the replacer gave it up. It returns to the replacer on its last unpin.
+        continue;
+      }
+      stripe.table_.erase(victim->page_id_);
+      // Swips still pointing at the frame find out from the generation.
+      ++victim->generation_;
+    }
+    stats_.AddEviction();
+    // The page is unreachable now, so it can be written back without holding the stripe.
+    if (victim->is_dirty_) {
+      FlushLogFor(victim);
+      disk_manager_->WritePage(victim->page_id_, victim->GetData());
+      stats_.AddDirtyWriteback();
+      victim->is_dirty_ = false;
+      // The background writer is falling behind.
+      bg_writer_cv_.notify_one();
+    }
+    // The page is clean now, keep it around compressed in case it is needed again soon.
+    if (compressed_cache_ != nullptr) {
+      compressed_cache_->Insert(victim->page_id_, victim->GetData());
+    }
+    if (static_cast<size_t>(*frame_id) >= pool_size_) {
+      // The frame is being dropped by a shrink, evicting its page was all there was to do.
+      victim->page_id_ = INVALID_PAGE_ID;
+      continue;
+    }
+    return true;
+  }
   return false;
 }
 
-bool BufferPoolManagerInstance::UnpinPgImp(page_id_t page_id, bool is_dirty) { return false; }
+bool BufferPoolManagerInstance::DrainFrames(size_t begin, size_t end) {
+  bool drained = true;
+  for (size_t i = begin; i < end; ++i) {
+    Page *page = &pages_[i];
+    if (page->page_id_ == INVALID_PAGE_ID) {
+      continue;
+    }
+    {
+      auto &stripe = StripeOf(page->page_id_);
+      std::scoped_lock stripe_lock(stripe.latch_);
+      if (page->pin_count_ > 0) {
+        drained = false;
+        continue;
+      }
+      stripe.table_.erase(page->page_id_);
+      ++page->generation_;
+      replacer_->Remove(static_cast<frame_id_t>(i));
+    }
+    if (page->is_dirty_) {
+      FlushLogFor(page);
+      disk_manager_->WritePage(page->page_id_, page->GetData());
+      page->is_dirty_ = false;
+    }
+    page->page_id_ = INVALID_PAGE_ID;
+  }
+  return drained;
+}
+
+bool BufferPoolManagerInstance::FindVictimFrame(BufferRing *ring, frame_id_t *frame_id) {
+  if (ring == nullptr || ring->slots_.size() < ring->size_) {
+    return FindVictimFrame(frame_id);
+  }
+  const auto [ring_frame_id, ring_page_id] = ring->slots_[ring->next_];
+  Page *page = &pages_[ring_frame_id];
+  bool recyclable;
+  {
+    auto &stripe = StripeOf(ring_page_id);
+    std::scoped_lock stripe_lock(stripe.latch_);
+    // The frame may have been evicted and reused by someone else, or the page may be in use again.
+    recyclable = page->page_id_ == ring_page_id && page->pin_count_ == 0 &&
+                 static_cast<size_t>(ring_frame_id) < pool_size_ &&
+                 !(page->is_dirty_ && ring->type_ == BufferAccessStrategyType::BULK_READ);
+    if (recyclable) {
+      stripe.table_.erase(ring_page_id);
+      ++page->generation_;
+      replacer_->Remove(ring_frame_id);
+    }
+  }
+  if (!recyclable) {
+    return FindVictimFrame(frame_id);
+  }
+  stats_.AddEviction();
+  if (page->is_dirty_) {
+    FlushLogFor(page);
+    disk_manager_->WritePage(ring_page_id, page->GetData());
+    stats_.AddDirtyWriteback();
+    page->is_dirty_ = false;
+  }
+  *frame_id = ring_frame_id;
+  return true;
+}
+
+void BufferPoolManagerInstance::ReadPage(page_id_t page_id, char *data) {
+  if (compressed_cache_ != nullptr && compressed_cache_->Take(page_id, data)) {
+    return;
+  }
+  disk_manager_->ReadPage(page_id, data);
+}
+
+void BufferPoolManagerInstance::DiscardFrame(frame_id_t frame_id) {
+  Page *page = &pages_[frame_id];
+  if (page->pin_count_ > 0) {
+    num_pinned_frames_.fetch_sub(1, std::memory_order_relaxed);
+  }
+  page->ResetMemory();
+  page->page_id_ = INVALID_PAGE_ID;
+  page->pin_count_ = 0;
+  page->is_dirty_ = false;
+  if (static_cast<size_t>(frame_id) < pool_size_) {
+    free_list_.push_back(frame_id);
+  }
+}
+
+lsn_t BufferPoolManagerInstance::UnloggedLSN(Page *page) {
+  if (!enable_logging || log_manager_ == nullptr) {
+    return INVALID_LSN;
+  }
+  const lsn_t lsn = page->GetLSN();
+  // Pages that are not logged keep other data where the LSN would be, no record has an LSN past the next one.
+  if (lsn <= log_manager_->GetPersistentLSN() || lsn >= log_manager_->GetNextLSN()) {
+    return INVALID_LSN;
+  }
+  return lsn;
+}
+
+void BufferPoolManagerInstance::FlushLogFor(Page *page) {
+  const lsn_t lsn = UnloggedLSN(page);
+  if (lsn != INVALID_LSN) {
+    log_manager_->FlushTo(lsn);
+  }
+}
 
-page_id_t BufferPoolManagerInstance::AllocatePage() {
-  const page_id_t next_page_id = next_page_id_;
-  next_page_id_ += num_instances_;
-  ValidatePageId(next_page_id);
-  return next_page_id;
+page_id_t BufferPoolManagerInstance::AllocatePage(page_id_t hint) {
+  const page_id_t page_id = free_page_map_->Allocate(hint);
+  ValidatePageId(page_id);
+  return page_id;
 }
 
 void BufferPoolManagerInstance::ValidatePageId(const page_id_t page_id) const {
@@ -0,0 +1,88 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_stats.cpp
+//
+// Identification: src/buffer/buffer_pool_stats.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/buffer_pool_stats.h"
+
+#include <algorithm>
+
+namespace bustub {
+
+uint64_t BufferPoolStatsSnapshot::MissLatencyPercentile(double percentile) const {
+  uint64_t total = 0;
+  for (auto count : miss_latency_histogram_) {
+    total += count;
+  }
+  if (total == 0) {
+    return 0;
+  }
+  // Rank of the sample the percentile falls on, counting from 1.
+  auto rank = static_cast<uint64_t>(percentile / 100 * static_cast<double>(total) + 0.5);
+  rank = rank == 0 ? 1 : rank;
+  uint64_t seen = 0;
+  for (size_t i = 0; i < NUM_LATENCY_BUCKETS; ++i) {
+    seen += miss_latency_histogram_[i];
+    if (seen >= rank) {
+      return uint64_t{1} << i;
+    }
+  }
+  return uint64_t{1} << (NUM_LATENCY_BUCKETS - 1);
+}
+
+BufferPoolStatsSnapshot &BufferPoolStatsSnapshot::operator+=(const BufferPoolStatsSnapshot &other) {
+  hits_ += other.hits_;
+  misses_ += other.misses_;
+  evictions_ += other.evictions_;
+  dirty_writebacks_ += other.dirty_writebacks_;
+  background_writes_ += other.background_writes_;
+  pin_waits_ += other.pin_waits_;
+  for (size_t i = 0; i < NUM_LATENCY_BUCKETS; ++i) {
+    miss_latency_histogram_[i] += other.miss_latency_histogram_[i];
+  }
+  compressed_hits_ += other.compressed_hits_;
+  compressed_misses_ += other.compressed_misses_;
+  compressed_bytes_ += other.compressed_bytes_;
+  return *this;
+}
+
+void BufferPoolStats::AddMiss(std::chrono::nanoseconds latency) {
+  auto &shard = Shard();
+  shard.misses_.fetch_add(1, std::memory_order_relaxed);
+  // Bucket i holds latencies below 2^i microseconds, the index is the bit length of the latency.
+  auto micros = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(latency).count());
+  const size_t bucket = std::min<size_t>(micros == 0 ? 0 : 64 - __builtin_clzll(micros),
+                                         BufferPoolStatsSnapshot::NUM_LATENCY_BUCKETS - 1);
+  shard.miss_latency_histogram_[bucket].fetch_add(1, std::memory_order_relaxed);
+}
+
+BufferPoolStatsSnapshot BufferPoolStats::GetSnapshot() const {
+  BufferPoolStatsSnapshot snapshot;
+  for (const auto &shard : shards_) {
+    snapshot.hits_ += shard.hits_.load(std::memory_order_relaxed);
+    snapshot.misses_ += shard.misses_.load(std::memory_order_relaxed);
+    snapshot.evictions_ += shard.evictions_.load(std::memory_order_relaxed);
+    snapshot.dirty_writebacks_ += shard.dirty_writebacks_.load(std::memory_order_relaxed);
+    snapshot.background_writes_ += shard.background_writes_.load(std::memory_order_relaxed);
+    snapshot.pin_waits_ += shard.pin_waits_.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < BufferPoolStatsSnapshot::NUM_LATENCY_BUCKETS; ++i) {
+      snapshot.miss_latency_histogram_[i] += shard.miss_latency_histogram_[i].load(std::memory_order_relaxed);
+    }
+  }
+  return snapshot;
+}
+
+size_t BufferPoolStats::ThreadShard() {
+  static std::atomic<size_t> next_shard{0};
+  thread_local const size_t shard = next_shard.fetch_add(1, std::memory_order_relaxed) % NUM_SHARDS;
+  return shard;
+}
+
+}  // namespace bustub
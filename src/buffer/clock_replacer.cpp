@@ -14,16 +14,71 @@
 
 namespace bustub {
 
-ClockReplacer::ClockReplacer(size_t num_pages) {}
+ClockReplacer::ClockReplacer(size_t num_pages) : in_clock_(num_pages, false), ref_(num_pages, false) {}
 
 ClockReplacer::~ClockReplacer() = default;
 
-bool ClockReplacer::Victim(frame_id_t *frame_id) { return false; }
+bool ClockReplacer::Victim(frame_id_t *frame_id) {
+  std::scoped_lock lock(latch_);
+  if (size_ == 0) {
+    return false;
+  }
+  // The first sweep clears every reference bit it passes, so the second one finds a victim at the latest.
+  const size_t num_slots = in_clock_.size();
+  while (true) {
+    const size_t slot = hand_;
+    hand_ = (hand_ + 1) % num_slots;
+    if (!in_clock_[slot]) {
+      continue;
+    }
+    if (ref_[slot]) {
+      ref_[slot] = false;
+      continue;
+    }
+    in_clock_[slot] = false;
+    size_--;
+    *frame_id = static_cast<frame_id_t>(slot);
+    return true;
+  }
+}
 
-void ClockReplacer::Pin(frame_id_t frame_id) {}
+void ClockReplacer::Pin(frame_id_t frame_id) {
+  std::scoped_lock lock(latch_);
+  if (!in_clock_[frame_id]) {
+    return;
+  }
+  in_clock_[frame_id] = false;
+  size_--;
+}
 
-void ClockReplacer::Unpin(frame_id_t frame_id) {}
+void ClockReplacer::Unpin(frame_id_t frame_id) {
+  std::scoped_lock lock(latch_);
+  if (in_clock_[frame_id]) {
+    return;
+  }
+  in_clock_[frame_id] = true;
+  ref_[frame_id] = true;
+  size_++;
+}
 
-size_t ClockReplacer::Size() { return 0; }
+void ClockReplacer::PeekVictims(size_t max_frames, std::vector<frame_id_t> *frame_ids) {
+  std::scoped_lock lock(latch_);
+  // The hand takes the frames with a clear bit in its first sweep and the rest in its second, both in slot order.
+  const size_t num_slots = in_clock_.size();
+  for (bool ref : {false, true}) {
+    for (size_t i = 0; i < num_slots && max_frames > 0; ++i) {
+      const size_t slot = (hand_ + i) % num_slots;
+      if (in_clock_[slot] && ref_[slot] == ref) {
+        frame_ids->push_back(static_cast<frame_id_t>(slot));
+        max_frames--;
+      }
+    }
+  }
+}
+
+size_t ClockReplacer::Size() {
+  std::scoped_lock lock(latch_);
+  return size_;
+}
 
 }  // namespace bustub
@@ -0,0 +1,93 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// compressed_page_cache.cpp
+//
+// Identification: src/buffer/compressed_page_cache.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/compressed_page_cache.h"
+
+#include "common/logger.h"
+#include "common/util/lz_compressor.h"
+
+namespace bustub {
+
+CompressedPageCache::CompressedPageCache(size_t capacity) : capacity_(capacity) {}
+
+bool CompressedPageCache::Insert(page_id_t page_id, const char *data) {
+  std::scoped_lock lock(latch_);
+  auto it = pages_.find(page_id);
+  if (it != pages_.end()) {
+    Erase(it);
+  }
+  const size_t size = LZCompressor::Compress(data, PAGE_SIZE, buffer_, MAX_COMPRESSED_SIZE);
+  if (size == 0 || size > capacity_) {
+    return false;
+  }
+  while (memory_used_ + size > capacity_) {
+    Erase(pages_.find(order_.front()));
+  }
+  order_.push_back(page_id);
+  pages_.emplace(page_id, CachedPage{std::vector<char>(buffer_, buffer_ + size), std::prev(order_.end())});
+  memory_used_ += size;
+  return true;
+}
+
+bool CompressedPageCache::Take(page_id_t page_id, char *data) {
+  std::scoped_lock lock(latch_);
+  auto it = pages_.find(page_id);
+  if (it == pages_.end()) {
+    misses_++;
+    return false;
+  }
+  const bool decompressed = LZCompressor::Decompress(it->second.data_.data(), it->second.data_.size(), data, PAGE_SIZE);
+  Erase(it);
+  if (!decompressed) {
+    LOG_DEBUG("corrupt compressed page %d", page_id);
+    misses_++;
+    return false;
+  }
+  hits_++;
+  return true;
+}
+
+void CompressedPageCache::Remove(page_id_t page_id) {
+  std::scoped_lock lock(latch_);
+  auto it = pages_.find(page_id);
+  if (it != pages_.end()) {
+    Erase(it);
+  }
+}
+
+uint64_t CompressedPageCache::GetHits() {
+  std::scoped_lock lock(latch_);
+  return hits_;
+}
+
+uint64_t CompressedPageCache::GetMisses() {
+  std::scoped_lock lock(latch_);
+  return misses_;
+}
+
+size_t CompressedPageCache::GetMemoryUsed() {
+  std::scoped_lock lock(latch_);
+  return memory_used_;
+}
+
+size_t CompressedPageCache::GetNumPages() {
+  std::scoped_lock lock(latch_);
+  return pages_.size();
+}
+
+void CompressedPageCache::Erase(std::unordered_map<page_id_t, CachedPage>::iterator it) {
+  memory_used_ -= it->second.data_.size();
+  order_.erase(it->second.position_);
+  pages_.erase(it);
+}
+
+}  // namespace bustub
@@ -0,0 +1,110 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_arena.cpp
+//
+// Identification: src/buffer/frame_arena.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/frame_arena.h"
+
+#include <sys/mman.h>
+
+#include <algorithm>
+#include <cstdint>
+
+#include "common/exception.h"
+#include "common/util/numa_util.h"
+
+namespace bustub {
+
+FrameArena::FrameArena(size_t num_frames, size_t max_frames, int numa_node)
+    : num_frames_(0), max_frames_(std::max(num_frames, max_frames)) {
+  const size_t size = max_frames_ * PAGE_SIZE;
+  if (size < HUGE_PAGE_SIZE) {
+    // A huge page would mostly be wasted on a small pool, mmap still gives us PAGE_SIZE alignment.
+    mapped_size_ = size;
+    void *addr = mmap(nullptr, mapped_size_, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (addr == MAP_FAILED) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "can't map buffer pool frames");
+    }
+    data_ = static_cast<char *>(addr);
+    if (numa_node >= 0) {
+      NumaUtil::BindMemory(data_, mapped_size_, numa_node);
+    }
+    if (!Resize(num_frames)) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "can't map buffer pool frames");
+    }
+    return;
+  }
+
+  // Round up to whole huge pages so that the tail of the pool is huge page backed as well.
+  mapped_size_ = (size + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+  if (max_frames_ == num_frames) {
+    // Reserved huge pages are committed as a whole, only use them for pools that do not change size.
+    void *addr =
+        mmap(nullptr, mapped_size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (addr != MAP_FAILED) {
+      data_ = static_cast<char *>(addr);
+      // Huge pages are taken from a node when they are faulted in, not when they are reserved.
+      if (numa_node >= 0) {
+        NumaUtil::BindMemory(data_, mapped_size_, numa_node);
+      }
+      num_frames_ = num_frames;
+      huge_pages_ = true;
+      return;
+    }
+  }
+
+  // Map a huge page more than needed, trim it down to a huge page aligned region and let transparent huge pages back
+  // it. Nothing is accessible until Resize, so the room to grow costs address space only.
+  void *addr = mmap(nullptr, mapped_size_ + HUGE_PAGE_SIZE, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (addr == MAP_FAILED) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "can't map buffer pool frames");
+  }
+  auto start = reinterpret_cast<uintptr_t>(addr);
+  auto aligned = (start + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+  if (aligned > start) {
+    munmap(addr, aligned - start);
+  }
+  if (start + HUGE_PAGE_SIZE > aligned) {
+    munmap(reinterpret_cast<void *>(aligned + mapped_size_), start + HUGE_PAGE_SIZE - aligned);
+  }
+  data_ = reinterpret_cast<char *>(aligned);
+  // Only a hint, the kernel may not have transparent huge pages enabled.
+  madvise(data_, mapped_size_, MADV_HUGEPAGE);
+  if (numa_node >= 0) {
+    NumaUtil::BindMemory(data_, mapped_size_, numa_node);
+  }
+  if (!Resize(num_frames)) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "can't map buffer pool frames");
+  }
+}
+
+FrameArena::~FrameArena() { munmap(data_, mapped_size_); }
+
+bool FrameArena::Resize(size_t num_frames) {
+  BUSTUB_ASSERT(num_frames <= max_frames_, "Cannot grow a frame arena beyond its reservation.");
+  if (huge_pages_) {
+    // Reserved huge pages cannot be given back piecemeal, the frames just stay mapped.
+    num_frames_ = num_frames;
+    return true;
+  }
+  if (num_frames > num_frames_) {
+    if (mprotect(GetFrameData(num_frames_), (num_frames - num_frames_) * PAGE_SIZE, PROT_READ | PROT_WRITE) != 0) {
+      return false;
+    }
+  } else if (num_frames < num_frames_) {
+    // Dropping the pages both releases the memory and makes the frames read back as zeroes when they return.
+    madvise(GetFrameData(num_frames), (num_frames_ - num_frames) * PAGE_SIZE, MADV_DONTNEED);
+    mprotect(GetFrameData(num_frames), (num_frames_ - num_frames) * PAGE_SIZE, PROT_NONE);
+  }
+  num_frames_ = num_frames;
+  return true;
+}
+
+}  // namespace bustub
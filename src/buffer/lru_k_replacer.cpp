@@ -0,0 +1,96 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lru_k_replacer.cpp
+//
+// Identification: src/buffer/lru_k_replacer.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/lru_k_replacer.h"
+
+#include "common/macros.h"
+
+namespace bustub {
+
+LRUKReplacer::LRUKReplacer(size_t num_pages, size_t k) : k_(k) {
+  BUSTUB_ASSERT(k > 0, "LRU-K needs to remember at least one access");
+  entries_.reserve(num_pages);
+}
+
+LRUKReplacer::~LRUKReplacer() = default;
+
+bool LRUKReplacer::Victim(frame_id_t *frame_id) {
+  std::scoped_lock lock(latch_);
+  auto *victims = infinite_set_.empty() ? &finite_set_ : &infinite_set_;
+  if (victims->empty()) {
+    return false;
+  }
+  *frame_id = victims->begin()->second;
+  victims->erase(victims->begin());
+  // The frame is about to hold a different page, so its history is meaningless from now on.
+  entries_.erase(*frame_id);
+  return true;
+}
+
+void LRUKReplacer::Pin(frame_id_t frame_id) {
+  std::scoped_lock lock(latch_);
+  auto &entry = entries_[frame_id];
+  if (entry.evictable_) {
+    SetOf(entry)->erase(KeyOf(frame_id, entry));
+    entry.evictable_ = false;
+  }
+  RecordAccess(&entry);
+}
+
+void LRUKReplacer::Unpin(frame_id_t frame_id) {
+  std::scoped_lock lock(latch_);
+  auto &entry = entries_[frame_id];
+  if (entry.evictable_) {
+    return;
+  }
+  if (entry.history_.empty()) {
+    // Unpinned without ever being pinned. Nobody has used the page yet, so do not count this as an access.
+    entry.admitted_ = current_timestamp_++;
+  }
+  entry.evictable_ = true;
+  SetOf(entry)->insert(KeyOf(frame_id, entry));
+}
+
+void LRUKReplacer::Remove(frame_id_t frame_id) {
+  std::scoped_lock lock(latch_);
+  auto it = entries_.find(frame_id);
+  if (it == entries_.end()) {
+    return;
+  }
+  if (it->second.evictable_) {
+    SetOf(it->second)->erase(KeyOf(frame_id, it->second));
+  }
+  entries_.erase(it);
+}
+
+void LRUKReplacer::PeekVictims(size_t max_frames, std::vector<frame_id_t> *frame_ids) {
+  std::scoped_lock lock(latch_);
+  for (const auto *victims : {&infinite_set_, &finite_set_}) {
+    for (auto it = victims->begin(); it != victims->end() && max_frames > 0; ++it, --max_frames) {
+      frame_ids->push_back(it->second);
+    }
+  }
+}
+
+size_t LRUKReplacer::Size() {
+  std::scoped_lock lock(latch_);
+  return infinite_set_.size() + finite_set_.size();
+}
+
+void LRUKReplacer::RecordAccess(FrameEntry *entry) {
+  entry->history_.push_back(current_timestamp_++);
+  if (entry->history_.size() > k_) {
+    entry->history_.pop_front();
+  }
+}
+
+}  // namespace bustub
@@ -14,16 +14,50 @@
 
 namespace bustub {
 
-LRUReplacer::LRUReplacer(size_t num_pages) {}
+LRUReplacer::LRUReplacer(size_t num_pages) { lru_map_.reserve(num_pages); }
 
 LRUReplacer::~LRUReplacer() = default;
 
-bool LRUReplacer::Victim(frame_id_t *frame_id) { return false; }
-
-void LRUReplacer::Pin(frame_id_t frame_id) {}
-
-void LRUReplacer::Unpin(frame_id_t frame_id) {}
-
-size_t LRUReplacer::Size() { return 0; }
+bool LRUReplacer::Victim(frame_id_t *frame_id) {
+  std::scoped_lock lock(latch_);
+  if (lru_list_.empty()) {
+    return false;
+  }
+  *frame_id = lru_list_.back();
+  lru_map_.erase(*frame_id);
+  lru_list_.pop_back();
+  return true;
+}
+
+void LRUReplacer::Pin(frame_id_t frame_id) {
+  std::scoped_lock lock(latch_);
+  auto it = lru_map_.find(frame_id);
+  if (it == lru_map_.end()) {
+    return;
+  }
+  lru_list_.erase(it->second);
+  lru_map_.erase(it);
+}
+
+void LRUReplacer::Unpin(frame_id_t frame_id) {
+  std::scoped_lock lock(latch_);
+  if (lru_map_.count(frame_id) != 0) {
+    return;
+  }
+  lru_list_.push_front(frame_id);
+  lru_map_.emplace(frame_id, lru_list_.begin());
+}
+
+void LRUReplacer::PeekVictims(size_t max_frames, std::vector<frame_id_t> *frame_ids) {
+  std::scoped_lock lock(latch_);
+  for (auto it = lru_list_.rbegin(); it != lru_list_.rend() && max_frames > 0; ++it, --max_frames) {
+    frame_ids->push_back(*it);
+  }
+}
+
+size_t LRUReplacer::Size() {
+  std::scoped_lock lock(latch_);
+  return lru_list_.size();
+}
 
 }  // namespace bustub
@@ -12,58 +12,234 @@
 
 #include "buffer/parallel_buffer_pool_manager.h"
 
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "common/exception.h"
+#include "common/util/numa_util.h"
+
 namespace bustub {
 
 ParallelBufferPoolManager::ParallelBufferPoolManager(size_t num_instances, size_t pool_size, DiskManager *disk_manager,
-                                                     LogManager *log_manager) {
-  // Allocate and create individual BufferPoolManagerInstances
+                                                     LogManager *log_manager, ReplacerType replacer_type,
+                                                     size_t max_pool_size)
+    : num_nodes_(NumaUtil::NumNodes()), node_instances_(num_nodes_) {
+  // Allocate and create individual BufferPoolManagerInstances. Only bind them to nodes if there is more than one.
+  instances_.reserve(num_instances);
+  for (size_t i = 0; i < num_instances; ++i) {
+    const int numa_node = static_cast<int>(i % num_nodes_);
+    instances_.push_back(new BufferPoolManagerInstance(pool_size, num_instances, i, disk_manager, log_manager,
+                                                       replacer_type, max_pool_size,
+                                                       num_nodes_ > 1 ? numa_node : -1));
+    node_instances_[numa_node].push_back(i);
+    all_instances_.push_back(i);
+  }
 }
 
-// Update constructor to destruct all BufferPoolManagerInstances and deallocate any associated memory
-ParallelBufferPoolManager::~ParallelBufferPoolManager() = default;
+ParallelBufferPoolManager::~ParallelBufferPoolManager() {
+  for (auto *instance : instances_) {
+    delete instance;
+  }
+}
 
 size_t ParallelBufferPoolManager::GetPoolSize() {
-  // Get size of all BufferPoolManagerInstances
-  return 0;
+  size_t pool_size = 0;
+  for (auto *instance : instances_) {
+    pool_size += instance->GetPoolSize();
+  }
+  return pool_size;
+}
+
+BufferPoolStatsSnapshot ParallelBufferPoolManager::GetStats() {
+  BufferPoolStatsSnapshot stats;
+  for (auto *instance : instances_) {
+    stats += instance->GetStats();
+  }
+  return stats;
+}
+
+bool ParallelBufferPoolManager::ResizePool(size_t pool_size) {
+  const size_t num_instances = instances_.size();
+  if (pool_size < num_instances) {
+    return false;
+  }
+  // The first pool_size % num_instances instances take one frame of the remainder each.
+  std::vector<size_t> instance_pool_sizes(num_instances);
+  for (size_t i = 0; i < num_instances; ++i) {
+    instance_pool_sizes[i] = pool_size / num_instances + (i < pool_size % num_instances ? 1 : 0);
+    if (instance_pool_sizes[i] > instances_[i]->GetMaxPoolSize()) {
+      return false;
+    }
+  }
+  std::vector<size_t> old_pool_sizes(num_instances);
+  for (size_t i = 0; i < num_instances; ++i) {
+    old_pool_sizes[i] = instances_[i]->GetPoolSize();
+    if (!instances_[i]->ResizePool(instance_pool_sizes[i])) {
+      // Put the instances resized so far back, so that the pool is not left split between the two sizes.
+      while (i-- > 0) {
+        instances_[i]->ResizePool(old_pool_sizes[i]);
+      }
+      return false;
+    }
+  }
+  return true;
+}
+
+bool ParallelBufferPoolManager::IsResident(page_id_t page_id) {
+  return GetBufferPoolManager(page_id)->IsResident(page_id);
+}
+
+bool ParallelBufferPoolManager::PeekResidentPage(page_id_t page_id, const std::function<void(Page *)> &reader) {
+  return GetBufferPoolManager(page_id)->PeekResidentPage(page_id, reader);
+}
+
+void ParallelBufferPoolManager::ReleaseAccessStrategy(uint64_t strategy_id) {
+  for (auto *instance : instances_) {
+    instance->ReleaseAccessStrategy(strategy_id);
+  }
 }
 
 BufferPoolManager *ParallelBufferPoolManager::GetBufferPoolManager(page_id_t page_id) {
-  // Get BufferPoolManager responsible for handling given page id. You can use this method in your other methods.
+  return instances_[page_id % instances_.size()];
+}
+
+void ParallelBufferPoolManager::CountAccess(size_t instance) {
+  if (num_nodes_ > 1 && static_cast<int>(instance % num_nodes_) != NumaUtil::CurrentNode()) {
+    remote_accesses_.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+Page *ParallelBufferPoolManager::NewPageLeastOccupied(page_id_t *page_id, BufferAccessStrategy *strategy) {
+  const size_t start = next_instance_.fetch_add(1);
+  if (enable_numa_local_allocation && num_nodes_ > 1) {
+    Page *page = NewPageIn(node_instances_[NumaUtil::CurrentNode() % num_nodes_], start, page_id, strategy);
+    if (page != nullptr) {
+      return page;
+    }
+  }
+  return NewPageIn(all_instances_, start, page_id, strategy);
+}
+
+Page *ParallelBufferPoolManager::NewPageIn(const std::vector<size_t> &candidates, size_t start, page_id_t *page_id,
+                                           BufferAccessStrategy *strategy) {
+  // Read the occupancy of every candidate once, a handful of relaxed loads is cheaper than a failed NewPage.
+  std::vector<std::pair<size_t, size_t>> order;
+  order.reserve(candidates.size());
+  for (size_t i = 0; i < candidates.size(); ++i) {
+    const size_t available = instances_[candidates[i]]->GetNumAvailableFrames();
+    if (available > 0) {
+      order.emplace_back(available, i);
+    }
+  }
+  // Most available frames first, ties go to the candidate whose turn it is, so that an even load stays round robin.
+  const size_t num_candidates = candidates.size();
+  std::sort(order.begin(), order.end(), [&](const auto &a, const auto &b) {
+    if (a.first != b.first) {
+      return a.first > b.first;
+    }
+    return (a.second + num_candidates - start % num_candidates) % num_candidates <
+           (b.second + num_candidates - start % num_candidates) % num_candidates;
+  });
+  // The counts are approximate, an instance may have filled up since we looked.
+  for (const auto &[available, i] : order) {
+    const size_t instance = candidates[i];
+    Page *page = instances_[instance]->NewPageWithStrategy(page_id, strategy);
+    if (page != nullptr) {
+      CountAccess(instance);
+      return page;
+    }
+  }
   return nullptr;
 }
 
 Page *ParallelBufferPoolManager::FetchPgImp(page_id_t page_id) {
-  // Fetch page for page_id from responsible BufferPoolManagerInstance
-  return nullptr;
+  CountAccess(page_id % instances_.size());
+  return GetBufferPoolManager(page_id)->FetchPage(page_id);
 }
 
 bool ParallelBufferPoolManager::UnpinPgImp(page_id_t page_id, bool is_dirty) {
-  // Unpin page_id from responsible BufferPoolManagerInstance
-  return false;
+  return GetBufferPoolManager(page_id)->UnpinPage(page_id, is_dirty);
 }
 
 bool ParallelBufferPoolManager::FlushPgImp(page_id_t page_id) {
-  // Flush page_id from responsible BufferPoolManagerInstance
-  return false;
+  return GetBufferPoolManager(page_id)->FlushPage(page_id);
 }
 
-Page *ParallelBufferPoolManager::NewPgImp(page_id_t *page_id) {
-  // create new page. We will request page allocation in a round robin manner from the underlying
-  // BufferPoolManagerInstances
-  // 1.   From a starting index of the BPMIs, call NewPageImpl until either 1) success and return 2) looped around to
-  // starting index and return nullptr
-  // 2.   Bump the starting index (mod number of instances) to start search at a different BPMI each time this function
-  // is called
-  return nullptr;
-}
+Page *ParallelBufferPoolManager::NewPgImp(page_id_t *page_id) { return NewPageLeastOccupied(page_id, nullptr); }
 
 bool ParallelBufferPoolManager::DeletePgImp(page_id_t page_id) {
-  // Delete page_id from responsible BufferPoolManagerInstance
-  return false;
+  return GetBufferPoolManager(page_id)->DeletePage(page_id);
+}
+
+void ParallelBufferPoolManager::FlushAllPgsImp() { BufferPoolManagerInstance::FlushInstances(instances_); }
+
+Page *ParallelBufferPoolManager::FetchPgWithStrategyImp(page_id_t page_id, BufferAccessStrategy *strategy) {
+  CountAccess(page_id % instances_.size());
+  return GetBufferPoolManager(page_id)->FetchPageWithStrategy(page_id, strategy);
+}
+
+Page *ParallelBufferPoolManager::FetchPgSwizzledImp(Swip *swip) {
+  CountAccess(swip->GetPageId() % instances_.size());
+  return GetBufferPoolManager(swip->GetPageId())->FetchPageSwizzled(swip);
+}
+
+bool ParallelBufferPoolManager::FetchPgsImp(const std::vector<page_id_t> &page_ids, Page **pages) {
+  std::vector<std::vector<size_t>> positions(instances_.size());
+  for (size_t i = 0; i < page_ids.size(); ++i) {
+    positions[page_ids[i] % instances_.size()].push_back(i);
+  }
+  bool fetched_all = true;
+  std::vector<page_id_t> instance_page_ids;
+  std::vector<Page *> instance_pages;
+  for (size_t instance = 0; instance < instances_.size(); ++instance) {
+    if (positions[instance].empty()) {
+      continue;
+    }
+    instance_page_ids.clear();
+    for (size_t i : positions[instance]) {
+      instance_page_ids.push_back(page_ids[i]);
+      CountAccess(instance);
+    }
+    instance_pages.resize(instance_page_ids.size());
+    try {
+      fetched_all = instances_[instance]->FetchPages(instance_page_ids, instance_pages.data()) && fetched_all;
+    } catch (const CorruptionException &) {
+      // The instance released its own pins, the ones the instances before it took go as well.
+      for (size_t done = 0; done < instance; ++done) {
+        for (size_t i : positions[done]) {
+          if (pages[i] != nullptr) {
+            instances_[done]->UnpinPage(page_ids[i], false);
+            pages[i] = nullptr;
+          }
+        }
+      }
+      throw;
+    }
+    for (size_t j = 0; j < positions[instance].size(); ++j) {
+      pages[positions[instance][j]] = instance_pages[j];
+    }
+  }
+  return fetched_all;
+}
+
+Page *ParallelBufferPoolManager::NewPgWithStrategyImp(page_id_t *page_id, BufferAccessStrategy *strategy) {
+  return NewPageLeastOccupied(page_id, strategy);
+}
+
+Page *ParallelBufferPoolManager::NewPgNearImp(page_id_t *page_id, page_id_t hint, BufferAccessStrategy *strategy) {
+  if (hint != INVALID_PAGE_ID) {
+    Page *page = GetBufferPoolManager(hint)->NewPageNear(page_id, hint, strategy);
+    if (page != nullptr) {
+      CountAccess(hint % instances_.size());
+      return page;
+    }
+  }
+  return NewPageLeastOccupied(page_id, strategy);
 }
 
-void ParallelBufferPoolManager::FlushAllPgsImp() {
-  // flush all pages from all BufferPoolManagerInstances
+void ParallelBufferPoolManager::PrefetchPgImp(page_id_t page_id, BufferAccessStrategy *strategy) {
+  GetBufferPoolManager(page_id)->PrefetchPage(page_id, strategy);
 }
 
 }  // namespace bustub
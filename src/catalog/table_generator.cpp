@@ -1,6 +1,7 @@
 #include "catalog/table_generator.h"
 
 #include <algorithm>
+#include <optional>
 #include <random>
 #include <vector>
 
@@ -64,6 +65,10 @@ std::vector<Value> TableGenerator::MakeValues(ColumnInsertMeta *col_meta, uint32
 void TableGenerator::FillTable(TableInfo *info, TableInsertMeta *table_meta) {
   uint32_t num_inserted = 0;
   uint32_t batch_size = 128;
+  // Loading a large table should not push whatever else is in the buffer pool out, once the table has grown past
+  // that point the rest of the load goes through a ring.
+  auto *bpm = exec_ctx_->GetBufferPoolManager();
+  std::optional<BufferAccessStrategy> strategy;
   while (num_inserted < table_meta->num_rows_) {
     std::vector<std::vector<Value>> values;
     uint32_t num_values = std::min(batch_size, table_meta->num_rows_ - num_inserted);
@@ -76,8 +81,12 @@ void TableGenerator::FillTable(TableInfo *info, TableInsertMeta *table_meta) {
       for (const auto &col : values) {
         entry.emplace_back(col[i]);
       }
+      if (!strategy && BufferAccessStrategy::IsLargeRelation(bpm, info->table_->GetNumPages())) {
+        strategy.emplace(bpm, BufferAccessStrategyType::BULK_WRITE);
+      }
       RID rid;
-      bool inserted = info->table_->InsertTuple(Tuple(entry, &info->schema_), &rid, exec_ctx_->GetTransaction());
+      bool inserted = info->table_->InsertTuple(Tuple(entry, &info->schema_), &rid, exec_ctx_->GetTransaction(),
+                                                strategy ? &*strategy : nullptr);
       BUSTUB_ASSERT(inserted, "Sequential insertion cannot fail");
       num_inserted++;
     }
@@ -18,6 +18,34 @@ std::atomic<bool> enable_logging(false);
 
 std::chrono::duration<int64_t> log_timeout = std::chrono::seconds(1);
 
+std::chrono::milliseconds async_commit_max_lag = std::chrono::milliseconds(10);
+
+std::atomic<size_t> async_commit_max_lag_bytes(LOG_BUFFER_SIZE);
+
 std::chrono::milliseconds cycle_detection_interval = std::chrono::milliseconds(50);
 
+std::atomic<size_t> read_ahead_window(4);
+
+std::chrono::milliseconds background_writer_interval = std::chrono::milliseconds(50);
+
+std::atomic<size_t> background_writer_max_pages(64);
+
+std::chrono::milliseconds buffer_pool_resize_timeout = std::chrono::milliseconds(1000);
+
+std::atomic<bool> enable_buffer_pool_dump(false);
+
+std::chrono::milliseconds buffer_pool_dump_interval = std::chrono::milliseconds(60000);
+
+std::atomic<bool> enable_numa_local_allocation(false);
+
+std::atomic<size_t> compressed_page_cache_size(0);
+
+std::atomic<bool> enable_io_uring(true);
+
+std::atomic<size_t> async_io_queue_depth(64);
+
+std::atomic<size_t> async_io_worker_threads(4);
+
+std::atomic<bool> enable_page_checksums(true);
+
 }  // namespace bustub
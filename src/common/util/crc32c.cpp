@@ -0,0 +1,132 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// crc32c.cpp
+//
+// Identification: src/common/util/crc32c.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "common/util/crc32c.h"
+
+#include <array>
+#include <cstring>
+
+#if defined(__SSE4_2__)
+#include <nmmintrin.h>
+#elif defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#endif
+
+namespace bustub {
+
+#if defined(__SSE4_2__) || defined(__ARM_FEATURE_CRC32)
+/** @return the CRC register after feeding it the eight bytes at data */
+static inline uint64_t CrcWord(uint64_t crc, const char *data) {
+  uint64_t word;
+  memcpy(&word, data, sizeof(word));
+#if defined(__SSE4_2__)
+  return _mm_crc32_u64(crc, word);
+#else
+  return __crc32cd(static_cast<uint32_t>(crc), word);
+#endif
+}
+
+/** Bytes of each of the three streams a large buffer is checksummed in, a third of a 4 KB page in whole words. */
+static constexpr size_t STREAM_SIZE = 1360;
+
+/** Tables that advance the CRC register over STREAM_SIZE zero bytes, one per byte of the register. */
+using ShiftTables = std::array<std::array<uint32_t, 256>, 4>;
+
+static ShiftTables MakeShiftTables() {
+  static const char zeroes[sizeof(uint64_t)] = {0};
+  ShiftTables tables{};
+  for (size_t byte = 0; byte < tables.size(); ++byte) {
+    for (uint32_t value = 0; value < 256; ++value) {
+      uint64_t crc = value << (8 * byte);
+      for (size_t i = 0; i < STREAM_SIZE; i += sizeof(uint64_t)) {
+        crc = CrcWord(crc, zeroes);
+      }
+      tables[byte][value] = static_cast<uint32_t>(crc);
+    }
+  }
+  return tables;
+}
+
+/** @return the CRC register after feeding it STREAM_SIZE zero bytes, which is linear in the register */
+static inline uint64_t ShiftCrc(const ShiftTables &tables, uint64_t crc) {
+  return tables[0][crc & 0xFF] ^ tables[1][(crc >> 8) & 0xFF] ^ tables[2][(crc >> 16) & 0xFF] ^
+         tables[3][(crc >> 24) & 0xFF];
+}
+#endif
+
+#if !defined(__SSE4_2__) && !defined(__ARM_FEATURE_CRC32)
+/** Reversed Castagnoli polynomial. */
+static constexpr uint32_t CRC32C_POLY = 0x82F63B78;
+
+/** @return the table for byte-at-a-time CRC-32C */
+static std::array<uint32_t, 256> MakeTable() {
+  std::array<uint32_t, 256> table{};
+  for (uint32_t i = 0; i < 256; ++i) {
+    uint32_t crc = i;
+    for (int bit = 0; bit < 8; ++bit) {
+      crc = (crc >> 1) ^ ((crc & 1) != 0 ? CRC32C_POLY : 0);
+    }
+    table[i] = crc;
+  }
+  return table;
+}
+#endif
+
+uint32_t Crc32c::Compute(const char *data, size_t size) {
+  uint32_t crc = ~uint32_t{0};
+#if defined(__SSE4_2__) || defined(__ARM_FEATURE_CRC32)
+  uint64_t crc64 = crc;
+  // A CRC32 instruction has to wait for the previous one, three independent streams keep the unit busy. The streams
+  // after the first start from zero, and the register of each stream is shifted over the next one to combine them.
+  if (size >= 3 * STREAM_SIZE) {
+    static const ShiftTables shift_tables = MakeShiftTables();
+    for (; size >= 3 * STREAM_SIZE; data += 3 * STREAM_SIZE, size -= 3 * STREAM_SIZE) {
+      uint64_t crc1 = 0;
+      uint64_t crc2 = 0;
+      for (size_t i = 0; i < STREAM_SIZE; i += sizeof(uint64_t)) {
+        crc64 = CrcWord(crc64, data + i);
+        crc1 = CrcWord(crc1, data + STREAM_SIZE + i);
+        crc2 = CrcWord(crc2, data + 2 * STREAM_SIZE + i);
+      }
+      crc64 = ShiftCrc(shift_tables, ShiftCrc(shift_tables, crc64) ^ crc1) ^ crc2;
+    }
+  }
+  // Eight bytes per instruction, then the tail a byte at a time.
+  for (; size >= sizeof(uint64_t); data += sizeof(uint64_t), size -= sizeof(uint64_t)) {
+    crc64 = CrcWord(crc64, data);
+  }
+  crc = static_cast<uint32_t>(crc64);
+  for (; size > 0; ++data, --size) {
+#if defined(__SSE4_2__)
+    crc = _mm_crc32_u8(crc, static_cast<uint8_t>(*data));
+#else
+    crc = __crc32cb(crc, static_cast<uint8_t>(*data));
+#endif
+  }
+#else
+  static const std::array<uint32_t, 256> table = MakeTable();
+  for (; size > 0; ++data, --size) {
+    crc = (crc >> 8) ^ table[(crc ^ static_cast<uint8_t>(*data)) & 0xFF];
+  }
+#endif
+  return ~crc;
+}
+
+bool Crc32c::IsHardwareAccelerated() {
+#if defined(__SSE4_2__) || defined(__ARM_FEATURE_CRC32)
+  return true;
+#else
+  return false;
+#endif
+}
+
+}  // namespace bustub
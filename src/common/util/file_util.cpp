@@ -0,0 +1,62 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// file_util.cpp
+//
+// Identification: src/common/util/file_util.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "common/util/file_util.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdio>
+
+namespace bustub {
+
+/** @return true if all of the data was written to the descriptor */
+static bool WriteAll(int fd, const std::string &data) {
+  for (size_t written = 0; written < data.size();) {
+    ssize_t result = write(fd, data.data() + written, data.size() - written);
+    if (result < 0 && errno == EINTR) {
+      continue;
+    }
+    if (result <= 0) {
+      return false;
+    }
+    written += result;
+  }
+  return true;
+}
+
+bool FileUtil::ReplaceFile(const std::string &file_name, const std::string &data) {
+  const std::string temp_file_name = file_name + ".tmp";
+  int fd = open(temp_file_name.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666);
+  if (fd < 0) {
+    return false;
+  }
+  // The contents have to be on disk before the rename makes them the file, or a crash could leave it empty.
+  const bool written = WriteAll(fd, data) && fsync(fd) == 0;
+  if (close(fd) != 0 || !written || rename(temp_file_name.c_str(), file_name.c_str()) != 0) {
+    remove(temp_file_name.c_str());
+    return false;
+  }
+  // The rename itself is only durable once the directory is.
+  const std::string::size_type slash = file_name.rfind('/');
+  const std::string dir_name = slash == std::string::npos ? "." : slash == 0 ? "/" : file_name.substr(0, slash);
+  int dir_fd = open(dir_name.c_str(), O_RDONLY | O_DIRECTORY);
+  if (dir_fd < 0) {
+    return false;
+  }
+  const bool synced = fsync(dir_fd) == 0;
+  close(dir_fd);
+  return synced;
+}
+
+}  // namespace bustub
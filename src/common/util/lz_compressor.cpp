@@ -0,0 +1,168 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lz_compressor.cpp
+//
+// Identification: src/common/util/lz_compressor.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "common/util/lz_compressor.h"
+
+#include <cstdint>
+#include <cstring>
+
+#include "common/macros.h"
+
+namespace bustub {
+
+/** Shortest match worth encoding. */
+static constexpr size_t MIN_MATCH = 4;
+/** Farthest back a match can start, offsets are 2 bytes. */
+static constexpr size_t MAX_OFFSET = 65535;
+/** log2 of the number of hash table entries. */
+static constexpr int HASH_BITS = 12;
+
+static inline uint32_t Load32(const char *p) {
+  uint32_t value;
+  memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+static inline uint32_t Hash(uint32_t sequence) { return (sequence * 2654435761U) >> (32 - HASH_BITS); }
+
+/** Write the extra bytes of a length whose nibble overflowed. @return false if they do not fit */
+static bool WriteLength(size_t length, char *dst, size_t capacity, size_t *op) {
+  for (; length >= 255; length -= 255) {
+    if (*op >= capacity) {
+      return false;
+    }
+    dst[(*op)++] = static_cast<char>(255);
+  }
+  if (*op >= capacity) {
+    return false;
+  }
+  dst[(*op)++] = static_cast<char>(length);
+  return true;
+}
+
+/** Read the extra bytes of a length whose nibble overflowed. @return false if the input ends first */
+static bool ReadLength(const uint8_t *src, size_t size, size_t *ip, size_t *length) {
+  uint8_t byte;
+  do {
+    if (*ip >= size) {
+      return false;
+    }
+    byte = src[(*ip)++];
+    *length += byte;
+  } while (byte == 255);
+  return true;
+}
+
+/** Write one sequence, a match_length of 0 marks the last one. @return false if it does not fit */
+static bool WriteSequence(const char *literals, size_t literal_length, size_t offset, size_t match_length, char *dst,
+                          size_t capacity, size_t *op) {
+  if (*op >= capacity) {
+    return false;
+  }
+  const size_t token_op = (*op)++;
+  const size_t match_code = match_length == 0 ? 0 : match_length - MIN_MATCH;
+  dst[token_op] = static_cast<char>((literal_length < 15 ? literal_length : 15) << 4 |
+                                    (match_code < 15 ? match_code : 15));
+  if (literal_length >= 15 && !WriteLength(literal_length - 15, dst, capacity, op)) {
+    return false;
+  }
+  if (*op + literal_length > capacity) {
+    return false;
+  }
+  memcpy(dst + *op, literals, literal_length);
+  *op += literal_length;
+  if (match_length == 0) {
+    return true;
+  }
+  if (*op + 2 > capacity) {
+    return false;
+  }
+  dst[(*op)++] = static_cast<char>(offset & 0xff);
+  dst[(*op)++] = static_cast<char>(offset >> 8);
+  return match_code < 15 || WriteLength(match_code - 15, dst, capacity, op);
+}
+
+size_t LZCompressor::Compress(const char *src, size_t size, char *dst, size_t capacity) {
+  BUSTUB_ASSERT(size <= MAX_INPUT_SIZE, "input too large to compress");
+  // Positions plus one of the last sequence seen with each hash, 0 if none.
+  uint32_t table[1 << HASH_BITS] = {};
+  size_t ip = 0;
+  size_t anchor = 0;
+  size_t op = 0;
+  while (ip + MIN_MATCH <= size) {
+    const uint32_t sequence = Load32(src + ip);
+    const uint32_t hash = Hash(sequence);
+    const size_t candidate = table[hash];
+    table[hash] = static_cast<uint32_t>(ip + 1);
+    if (candidate == 0 || ip - (candidate - 1) > MAX_OFFSET || Load32(src + candidate - 1) != sequence) {
+      ip++;
+      continue;
+    }
+    const size_t match = candidate - 1;
+    size_t match_length = MIN_MATCH;
+    while (ip + match_length < size && src[match + match_length] == src[ip + match_length]) {
+      match_length++;
+    }
+    if (!WriteSequence(src + anchor, ip - anchor, ip - match, match_length, dst, capacity, &op)) {
+      return 0;
+    }
+    ip += match_length;
+    anchor = ip;
+  }
+  if (!WriteSequence(src + anchor, size - anchor, 0, 0, dst, capacity, &op)) {
+    return 0;
+  }
+  return op;
+}
+
+bool LZCompressor::Decompress(const char *src, size_t size, char *dst, size_t capacity) {
+  const auto *in = reinterpret_cast<const uint8_t *>(src);
+  size_t ip = 0;
+  size_t op = 0;
+  while (ip < size) {
+    const uint8_t token = in[ip++];
+    size_t literal_length = token >> 4;
+    if (literal_length == 15 && !ReadLength(in, size, &ip, &literal_length)) {
+      return false;
+    }
+    if (ip + literal_length > size || op + literal_length > capacity) {
+      return false;
+    }
+    memcpy(dst + op, src + ip, literal_length);
+    ip += literal_length;
+    op += literal_length;
+    if (ip == size) {
+      // The last sequence has no match.
+      break;
+    }
+    if (ip + 2 > size) {
+      return false;
+    }
+    const size_t offset = in[ip] | static_cast<size_t>(in[ip + 1]) << 8;
+    ip += 2;
+    size_t match_length = token & 0xf;
+    if (match_length == 15 && !ReadLength(in, size, &ip, &match_length)) {
+      return false;
+    }
+    match_length += MIN_MATCH;
+    if (offset == 0 || offset > op || op + match_length > capacity) {
+      return false;
+    }
+    // Byte by byte, a match may overlap the bytes it produces.
+    for (size_t i = 0; i < match_length; ++i, ++op) {
+      dst[op] = dst[op - offset];
+    }
+  }
+  return op == capacity;
+}
+
+}  // namespace bustub
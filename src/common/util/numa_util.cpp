@@ -0,0 +1,102 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// numa_util.cpp
+//
+// Identification: src/common/util/numa_util.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "common/util/numa_util.h"
+
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <exception>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace bustub {
+
+/** Memory policy of mbind(2) that prefers a node but falls back to the others, from linux/mempolicy.h. */
+static constexpr int MPOL_PREFERRED_MODE = 1;
+
+/**
+ * Read a list of ranges like "0-1,3" from a sysfs file.
+ * @return the numbers in the ranges, empty if the file is missing or malformed
+ */
+static std::vector<int> ReadList(const std::string &file_name) {
+  std::ifstream in(file_name);
+  std::string ranges;
+  std::vector<int> list;
+  if (!(in >> ranges)) {
+    return list;
+  }
+  size_t start = 0;
+  while (start < ranges.size()) {
+    size_t end = ranges.find(',', start);
+    if (end == std::string::npos) {
+      end = ranges.size();
+    }
+    const std::string range = ranges.substr(start, end - start);
+    const size_t dash = range.find('-');
+    try {
+      const int first = std::stoi(range.substr(0, dash));
+      const int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+      for (int i = first; i <= last; ++i) {
+        list.push_back(i);
+      }
+    } catch (const std::exception &e) {
+      return {};
+    }
+    start = end + 1;
+  }
+  return list;
+}
+
+int NumaUtil::NumNodes() {
+  // The topology does not change while we run, so read it once.
+  static const int num_nodes = [] {
+    const std::vector<int> nodes = ReadList("/sys/devices/system/node/online");
+    return nodes.empty() ? 1 : *std::max_element(nodes.begin(), nodes.end()) + 1;
+  }();
+  return num_nodes;
+}
+
+int NumaUtil::CurrentNode() {
+  // sched_getcpu() is served from the vDSO without a system call, which keeps it cheap enough for the buffer pool hit
+  // path. The node of every CPU is read once.
+  static const std::vector<int> node_of_cpu = [] {
+    std::vector<int> node_of_cpu;
+    for (int node = 0; node < NumNodes(); ++node) {
+      for (int cpu : ReadList("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist")) {
+        if (static_cast<size_t>(cpu) >= node_of_cpu.size()) {
+          node_of_cpu.resize(cpu + 1, 0);
+        }
+        node_of_cpu[cpu] = node;
+      }
+    }
+    return node_of_cpu;
+  }();
+  const int cpu = sched_getcpu();
+  if (cpu < 0 || static_cast<size_t>(cpu) >= node_of_cpu.size()) {
+    return 0;
+  }
+  return node_of_cpu[cpu];
+}
+
+bool NumaUtil::BindMemory(void *addr, size_t length, int node) {
+  if (node < 0 || node >= NumNodes() || node >= static_cast<int>(sizeof(unsigned long) * 8)) {  // NOLINT
+    return false;
+  }
+  const unsigned long node_mask = 1UL << node;  // NOLINT
+  return syscall(SYS_mbind, addr, length, MPOL_PREFERRED_MODE, &node_mask, sizeof(node_mask) * 8 + 1, 0) == 0;
+}
+
+}  // namespace bustub
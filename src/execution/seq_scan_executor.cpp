@@ -14,10 +14,41 @@
 
 namespace bustub {
 
-SeqScanExecutor::SeqScanExecutor(ExecutorContext *exec_ctx, const SeqScanPlanNode *plan) : AbstractExecutor(exec_ctx) {}
+SeqScanExecutor::SeqScanExecutor(ExecutorContext *exec_ctx, const SeqScanPlanNode *plan)
+    : AbstractExecutor(exec_ctx), plan_(plan) {}
 
-void SeqScanExecutor::Init() {}
+void SeqScanExecutor::Init() {
+  table_info_ = exec_ctx_->GetCatalog()->GetTable(plan_->GetTableOid());
+  // Drop the iterator before the strategy it reads through.
+  iterator_.reset();
+  strategy_.reset();
+  // Only a table big enough to flush the pool is scanned through a ring, small ones stay cached.
+  if (BufferAccessStrategy::IsLargeRelation(exec_ctx_->GetBufferPoolManager(), table_info_->table_->GetNumPages())) {
+    strategy_ =
+        std::make_unique<BufferAccessStrategy>(exec_ctx_->GetBufferPoolManager(), BufferAccessStrategyType::BULK_READ);
+  }
+  iterator_ = std::make_unique<TableIterator>(table_info_->table_->Begin(exec_ctx_->GetTransaction(), strategy_.get()));
+}
 
-bool SeqScanExecutor::Next(Tuple *tuple, RID *rid) { return false; }
+bool SeqScanExecutor::Next(Tuple *tuple, RID *rid) {
+  const Schema &table_schema = table_info_->schema_;
+  const AbstractExpression *predicate = plan_->GetPredicate();
+  while (*iterator_ != table_info_->table_->End()) {
+    const Tuple &current = **iterator_;
+    if (predicate == nullptr || predicate->Evaluate(&current, &table_schema).GetAs<bool>()) {
+      std::vector<Value> values;
+      values.reserve(GetOutputSchema()->GetColumnCount());
+      for (const auto &column : GetOutputSchema()->GetColumns()) {
+        values.emplace_back(column.GetExpr()->Evaluate(&current, &table_schema));
+      }
+      *tuple = Tuple(values, GetOutputSchema());
+      *rid = current.GetRid();
+      ++(*iterator_);
+      return true;
+    }
+    ++(*iterator_);
+  }
+  return false;
+}
 
 }  // namespace bustub
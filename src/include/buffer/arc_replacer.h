@@ -0,0 +1,123 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// arc_replacer.h
+//
+// Identification: src/include/buffer/arc_replacer.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <list>
+#include <mutex>  // NOLINT
+#include <unordered_map>
+#include <vector>
+
+#include "buffer/replacer.h"
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * ARCReplacer implements the Adaptive Replacement Cache policy (Megiddo and Modha).
+ *
+ * Resident pages are split into T1, pages accessed once since they were loaded, and T2, pages accessed again. Pages
+ * evicted from T1 and T2 are remembered by page id in the ghost lists B1 and B2. A miss on a page in B1 means T1 was
+ * too small and grows the target size p of T1; a miss on a page in B2 shrinks it. Victims come from T1 while it holds
+ * more than p pages, otherwise from T2, least recently unpinned first. The split between recency and frequency thus
+ * follows the workload: scans stay in T1 and never push out T2, while a working set that shifts is picked up through
+ * the hits in B1.
+ *
+ * Pages are only known by id if the buffer pool tells the replacer through AssignPage(). Frames it was not told
+ * about are replaced like any other page but leave no ghost behind.
+ */
+class ARCReplacer : public Replacer {
+ public:
+  /**
+   * Create a new ARCReplacer.
+   * @param num_pages the maximum number of pages the ARCReplacer will be required to store
+   */
+  explicit ARCReplacer(size_t num_pages);
+
+  /**
+   * Destroys the ARCReplacer.
+   */
+  ~ARCReplacer() override;
+
+  bool Victim(frame_id_t *frame_id) override;
+
+  void Pin(frame_id_t frame_id) override;
+
+  void Unpin(frame_id_t frame_id) override;
+
+  void AssignPage(frame_id_t frame_id, page_id_t page_id) override;
+
+  void Remove(frame_id_t frame_id) override;
+
+  void PeekVictims(size_t max_frames, std::vector<frame_id_t> *frame_ids) override;
+
+  size_t Size() override;
+
+  /** @return the current target size of T1 */
+  size_t GetTargetRecencySize();
+
+ private:
+  /** A resident page. */
+  struct FrameEntry {
+    page_id_t page_id_{INVALID_PAGE_ID};
+    /** True if the page is in T2. */
+    bool frequent_{false};
+    /** Number of pins since the page was loaded, the first one is the access that loaded it. */
+    size_t accesses_{0};
+    /** True if the frame is unpinned and can be victimized. */
+    bool evictable_{false};
+    /** Position in t1_ or t2_ while evictable. */
+    std::list<frame_id_t>::iterator position_;
+  };
+
+  /** A page that was evicted. */
+  struct GhostEntry {
+    /** True if the page is in B2. */
+    bool frequent_;
+    /** Position in b1_ or b2_. */
+    std::list<page_id_t>::iterator position_;
+  };
+
+  /** @return the entry of the frame, creating a T1 entry for a frame never seen before */
+  FrameEntry &EntryOf(frame_id_t frame_id);
+
+  /** @return true if the next victim should come from T1 */
+  bool PreferRecent(size_t t1_size, bool t1_empty, bool t2_empty) const;
+
+  /** Remember an evicted page in B1 or B2, trimming the ghost lists to their bounds. */
+  void AddGhost(page_id_t page_id, bool frequent);
+
+  /** Forget the least recently evicted page of B1 or B2. */
+  void DropGhost(bool frequent);
+
+  /** Number of frames, c in the paper. */
+  const size_t capacity_;
+  /** Target size of T1, p in the paper. */
+  size_t target_t1_{0};
+  /** Every resident page the replacer knows of, by frame. */
+  std::unordered_map<frame_id_t, FrameEntry> entries_;
+  /** Number of resident pages in T1 and T2, pinned or not. */
+  size_t t1_size_{0};
+  size_t t2_size_{0};
+  /** Evictable frames of T1 and T2, most recently unpinned at the front. */
+  std::list<frame_id_t> t1_;
+  std::list<frame_id_t> t2_;
+  /** Ids of pages evicted from T1 and T2, most recently evicted at the front. */
+  std::list<page_id_t> b1_;
+  std::list<page_id_t> b2_;
+  /** Every ghost page, by page id. */
+  std::unordered_map<page_id_t, GhostEntry> ghosts_;
+  /** Protects all of the above. */
+  std::mutex latch_;
+};
+
+}  // namespace bustub
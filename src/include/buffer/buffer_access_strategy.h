@@ -0,0 +1,86 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_access_strategy.h
+//
+// Identification: src/include/buffer/buffer_access_strategy.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+class BufferPoolManager;
+
+/** How a bulk operation uses its ring of frames. */
+enum class BufferAccessStrategyType {
+  /** Large scans. Dirty frames are left to the regular eviction path instead of being written back by the scan. */
+  BULK_READ,
+  /** Bulk loads. The operation writes back the frames it dirtied itself when it comes around the ring. */
+  BULK_WRITE
+};
+
+/**
+ * BufferAccessStrategy lets a large sequential operation read through the buffer pool without evicting everybody
+ * else's working set. Pages it misses on are loaded into a small ring of frames that is recycled over and over,
+ * instead of taking victims from the shared replacer every time. Pages that are already resident are used as is.
+ *
+ * A strategy is owned by a single operation (a scan, a bulk insert). The rings themselves live in the buffer pool, so
+ * the strategy can be handed to background prefetches safely, and are released when the strategy is destroyed.
+ */
+class BufferAccessStrategy {
+ public:
+  /**
+   * Creates a new BufferAccessStrategy.
+   * @param buffer_pool_manager the buffer pool the operation reads through
+   * @param type the kind of bulk operation
+   */
+  BufferAccessStrategy(BufferPoolManager *buffer_pool_manager, BufferAccessStrategyType type);
+
+  /**
+   * Releases the frames of the ring back to the shared pool.
+   */
+  ~BufferAccessStrategy();
+
+  DISALLOW_COPY_AND_MOVE(BufferAccessStrategy);
+
+  /**
+   * Small relations stay cached in the shared pool, only an operation over a relation large enough to push a good
+   * part of the pool out is worth a ring.
+   * @param buffer_pool_manager the buffer pool the operation reads through
+   * @param num_pages the number of pages of the relation
+   * @return true if the operation should go through a strategy
+   */
+  static bool IsLargeRelation(BufferPoolManager *buffer_pool_manager, size_t num_pages);
+
+  /** @return the id the buffer pool knows the ring of this strategy by */
+  inline uint64_t GetId() const { return id_; }
+
+  /** @return the kind of bulk operation */
+  inline BufferAccessStrategyType GetType() const { return type_; }
+
+  /** @return the maximum number of frames the strategy recycles in each buffer pool instance */
+  inline size_t GetRingSize() const {
+    return type_ == BufferAccessStrategyType::BULK_WRITE ? BULK_WRITE_RING_SIZE : BULK_READ_RING_SIZE;
+  }
+
+ private:
+  /** Source of strategy ids, never reused so that a stale prefetch cannot pick up the ring of a newer strategy. */
+  static std::atomic<uint64_t> next_id_;
+
+  BufferPoolManager *buffer_pool_manager_;
+  BufferAccessStrategyType type_;
+  uint64_t id_;
+};
+
+}  // namespace bustub
@@ -12,11 +12,16 @@
 
 #pragma once
 
+#include <functional>
 #include <list>
 #include <mutex>  // NOLINT
 #include <unordered_map>
+#include <vector>
 
+#include "buffer/buffer_access_strategy.h"
+#include "buffer/buffer_pool_stats.h"
 #include "buffer/lru_replacer.h"
+#include "buffer/swip.h"
 #include "recovery/log_manager.h"
 #include "storage/disk/disk_manager.h"
 #include "storage/page/page.h"
@@ -84,6 +89,90 @@ class BufferPoolManager {
     GradingCallback(callback, CallbackType::AFTER, INVALID_PAGE_ID);
   }
 
+  /**
+   * Fetch the requested page on behalf of a bulk operation. On a miss the page is loaded into a frame of the
+   * strategy's ring rather than into a victim of the shared replacer.
+   * @param page_id id of page to be fetched
+   * @param strategy access strategy of the operation, nullptr behaves like FetchPage
+   * @return the requested page
+   */
+  Page *FetchPageWithStrategy(page_id_t page_id, BufferAccessStrategy *strategy) {
+    return strategy == nullptr ? FetchPgImp(page_id) : FetchPgWithStrategyImp(page_id, strategy);
+  }
+
+  /**
+   * Fetch several pages at once. Every page that could be fetched is pinned once per occurrence in page_ids, as if by
+   * FetchPage. Buffer pools that support it look all pages up under one latch acquisition and read the misses
+   * together.
+   * @param page_ids ids of the pages to be fetched
+   * @param[out] pages the fetched pages, in the order of page_ids, nullptr for a page that could not be fetched
+   * @return true if every page was fetched
+   * @throws CorruptionException if a page read from disk does not match its checksum, no page is left pinned then
+   */
+  bool FetchPages(const std::vector<page_id_t> &page_ids, Page **pages) { return FetchPgsImp(page_ids, pages); }
+
+  /**
+   * Fetch the page a swip references. While the page stays resident, fetching it through a swizzled swip goes
+   * straight to its frame. The swip is swizzled or unswizzled as a side effect.
+   * @param swip reference to the page to be fetched
+   * @return the requested page
+   */
+  Page *FetchPageSwizzled(Swip *swip) { return FetchPgSwizzledImp(swip); }
+
+  /**
+   * Creates a new page on behalf of a bulk operation, in a frame of the strategy's ring.
+   * @param[out] page_id id of created page
+   * @param strategy access strategy of the operation, nullptr behaves like NewPage
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  Page *NewPageWithStrategy(page_id_t *page_id, BufferAccessStrategy *strategy) {
+    return strategy == nullptr ? NewPgImp(page_id) : NewPgWithStrategyImp(page_id, strategy);
+  }
+
+  /**
+   * Creates a new page whose id is close to another page's, so that pages read together (the next page of a table
+   * heap chain, a B+ tree sibling) stay close together on disk.
+   * @param[out] page_id id of created page
+   * @param hint id of a page the new page should be close to, INVALID_PAGE_ID for none
+   * @param strategy access strategy of the operation, if any
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  Page *NewPageNear(page_id_t *page_id, page_id_t hint, BufferAccessStrategy *strategy = nullptr) {
+    return NewPgNearImp(page_id, hint, strategy);
+  }
+
+  /**
+   * Hint that the page will be fetched soon. The page is loaded in the background if the buffer pool supports it,
+   * without pinning it. This never blocks on I/O.
+   * @param page_id id of page to be prefetched
+   * @param strategy access strategy of the operation the page is prefetched for, if any
+   */
+  void PrefetchPage(page_id_t page_id, BufferAccessStrategy *strategy = nullptr) { PrefetchPgImp(page_id, strategy); }
+
+  /**
+   * Forget the ring of an access strategy. Its frames go back to being ordinary frames of the shared pool.
+   * @param strategy_id id of the strategy being destroyed
+   */
+  virtual void ReleaseAccessStrategy(uint64_t strategy_id) {}
+
+  /**
+   * @param page_id id of page
+   * @return true if the page is currently held in the buffer pool. Only a hint, the page may be evicted right after.
+   */
+  virtual bool IsResident(page_id_t page_id) { return false; }
+
+  /**
+   * Look at a page if it is held in the buffer pool, without reading it from disk if it is not. The page is kept from
+   * being evicted meanwhile, but this does not count as an access to it for the replacer.
+   * @param page_id id of page
+   * @param reader called with the page, which it must latch to read
+   * @return false if the page is not held in the buffer pool
+   */
+  virtual bool PeekResidentPage(page_id_t page_id, const std::function<void(Page *)> &reader) { return false; }
+
+  /** @return the statistics of the buffer pool, all zero if it does not keep any */
+  virtual BufferPoolStatsSnapshot GetStats() { return {}; }
+
   /** @return size of the buffer pool */
   virtual size_t GetPoolSize() = 0;
 
@@ -105,6 +194,7 @@ class BufferPoolManager {
    * Fetch the requested page from the buffer pool.
    * @param page_id id of page to be fetched
    * @return the requested page
+   * @throws CorruptionException if the page read from disk does not match its checksum
    */
   virtual Page *FetchPgImp(page_id_t page_id) = 0;
 
@@ -141,5 +231,65 @@ class BufferPoolManager {
    * Flushes all the pages in the buffer pool to disk.
    */
   virtual void FlushAllPgsImp() = 0;
+
+  /**
+   * Fetch the requested page, recycling a frame of the strategy's ring on a miss. Buffer pools without rings fetch the
+   * page as usual.
+   * @param page_id id of page to be fetched
+   * @param strategy access strategy of the operation
+   * @return the requested page
+   */
+  virtual Page *FetchPgWithStrategyImp(page_id_t page_id, BufferAccessStrategy *strategy) {
+    return FetchPgImp(page_id);
+  }
+
+  /**
+   * Fetch several pages at once. Buffer pools without batched I/O fetch them one by one.
+   * @param page_ids ids of the pages to be fetched
+   * @param[out] pages the fetched pages, nullptr for a page that could not be fetched
+   * @return true if every page was fetched
+   */
+  virtual bool FetchPgsImp(const std::vector<page_id_t> &page_ids, Page **pages) {
+    bool fetched_all = true;
+    for (size_t i = 0; i < page_ids.size(); ++i) {
+      pages[i] = FetchPgImp(page_ids[i]);
+      fetched_all = fetched_all && pages[i] != nullptr;
+    }
+    return fetched_all;
+  }
+
+  /**
+   * Fetch the page a swip references. Buffer pools that do not swizzle look the page id up as usual.
+   * @param swip reference to the page to be fetched
+   * @return the requested page
+   */
+  virtual Page *FetchPgSwizzledImp(Swip *swip) { return FetchPgImp(swip->GetPageId()); }
+
+  /**
+   * Creates a new page in a frame of the strategy's ring. Buffer pools without rings create the page as usual.
+   * @param[out] page_id id of created page
+   * @param strategy access strategy of the operation
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  virtual Page *NewPgWithStrategyImp(page_id_t *page_id, BufferAccessStrategy *strategy) { return NewPgImp(page_id); }
+
+  /**
+   * Creates a new page, preferring a page id close to the hint. Buffer pools without free page tracking ignore the
+   * hint.
+   * @param[out] page_id id of created page
+   * @param hint id of a page the new page should be close to, INVALID_PAGE_ID for none
+   * @param strategy access strategy of the operation, if any
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  virtual Page *NewPgNearImp(page_id_t *page_id, page_id_t hint, BufferAccessStrategy *strategy) {
+    return strategy == nullptr ? NewPgImp(page_id) : NewPgWithStrategyImp(page_id, strategy);
+  }
+
+  /**
+   * Start loading the page in the background. Buffer pools without background I/O ignore the hint.
+   * @param page_id id of page to be prefetched
+   * @param strategy access strategy of the operation the page is prefetched for, if any
+   */
+  virtual void PrefetchPgImp(page_id_t page_id, BufferAccessStrategy *strategy) {}
 };
 }  // namespace bustub
@@ -12,14 +12,28 @@
 
 #pragma once
 
+#include <array>
+#include <chrono>  // NOLINT
+#include <condition_variable>  // NOLINT
+#include <deque>
 #include <list>
 #include <mutex>  // NOLINT
+#include <string>
+#include <thread>  // NOLINT
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
+#include "buffer/arc_replacer.h"
 #include "buffer/buffer_pool_manager.h"
+#include "buffer/clock_replacer.h"
+#include "buffer/compressed_page_cache.h"
+#include "buffer/frame_arena.h"
+#include "buffer/lru_k_replacer.h"
 #include "buffer/lru_replacer.h"
 #include "recovery/log_manager.h"
 #include "storage/disk/disk_manager.h"
+#include "storage/disk/free_page_map.h"
 #include "storage/page/page.h"
 
 namespace bustub {
@@ -34,8 +48,11 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    * @param pool_size the size of the buffer pool
    * @param disk_manager the disk manager
    * @param log_manager the log manager (for testing only: nullptr = disable logging)
+   * @param replacer_type the replacement policy used to pick victim frames
+   * @param max_pool_size the size the buffer pool may grow to at runtime, no growth if not larger than pool_size
    */
-  BufferPoolManagerInstance(size_t pool_size, DiskManager *disk_manager, LogManager *log_manager = nullptr);
+  BufferPoolManagerInstance(size_t pool_size, DiskManager *disk_manager, LogManager *log_manager = nullptr,
+                            ReplacerType replacer_type = ReplacerType::LRU, size_t max_pool_size = 0);
   /**
    * Creates a new BufferPoolManagerInstance.
    * @param pool_size the size of the buffer pool
@@ -43,9 +60,14 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    * @param instance_index index of this BPI in the parallel BPM
    * @param disk_manager the disk manager
    * @param log_manager the log manager (for testing only: nullptr = disable logging)
+   * @param replacer_type the replacement policy used to pick victim frames
+   * @param max_pool_size the size the buffer pool may grow to at runtime, no growth if not larger than pool_size
+   * @param numa_node NUMA node to place the frames and their book-keeping on, -1 to leave it to the system
    */
   BufferPoolManagerInstance(size_t pool_size, uint32_t num_instances, uint32_t instance_index,
-                            DiskManager *disk_manager, LogManager *log_manager = nullptr);
+                            DiskManager *disk_manager, LogManager *log_manager = nullptr,
+                            ReplacerType replacer_type = ReplacerType::LRU, size_t max_pool_size = 0,
+                            int numa_node = -1);
 
   /**
    * Destroys an existing BufferPoolManagerInstance.
@@ -55,9 +77,71 @@ class BufferPoolManagerInstance : public BufferPoolManager {
   /** @return size of the buffer pool */
   size_t GetPoolSize() override { return pool_size_; }
 
+  /** @return the statistics of the buffer pool since it was created, including its compressed tier */
+  BufferPoolStatsSnapshot GetStats() override;
+
+  /**
+   * Approximate number of frames a new page could go into, free or holding an unpinned page. Reading it takes no
+   * latch, it may be off by the pins and unpins that race with the call.
+   * @return the number of frames that are not pinned
+   */
+  size_t GetNumAvailableFrames() const;
+
+  /** @return the NUMA node the buffer pool is placed on, -1 if it was left to the system */
+  int GetNumaNode() const { return numa_node_; }
+
   /** @return pointer to all the pages in the buffer pool */
   Page *GetPages() { return pages_; }
 
+  /** @return the size the buffer pool may grow to */
+  size_t GetMaxPoolSize() const { return max_pool_size_; }
+
+  /**
+   * Change the number of frames while the buffer pool is in use. Growing makes new frames available right away.
+   * Shrinking stops handing out the frames past the new size, then evicts their pages, writing back dirty ones. Pinned
+   * pages are waited for until buffer_pool_resize_timeout; if they are not released by then the size is left as is.
+   * @param pool_size the new number of frames, between 1 and GetMaxPoolSize()
+   * @return true if the buffer pool has the new size
+   */
+  bool ResizePool(size_t pool_size);
+
+  /**
+   * Save the ids of the resident pages with their hotness, replacing the previous dump. With enable_buffer_pool_dump
+   * this happens periodically and at shutdown, and the next instance on the same database warms up from the dump.
+   */
+  void DumpResidentPages();
+
+  /**
+   * Write back the dirty pages of several instances sharing a disk manager as one batch: the pages of all instances
+   * are sorted by page id, so that neighbouring pages go out in a single sequential write, and the database file is
+   * flushed once at the end. The dirty pages are pinned while they are written, misses do not wait for the flush.
+   * @param instances the instances to flush, all using the same disk manager
+   */
+  static void FlushInstances(const std::vector<BufferPoolManagerInstance *> &instances);
+
+  /** @return the file the resident pages are saved to */
+  const std::string &GetDumpFileName() const { return dump_file_name_; }
+
+  /**
+   * @param page_id id of page
+   * @return true if the page is currently held in the buffer pool
+   */
+  bool IsResident(page_id_t page_id) override;
+
+  /**
+   * Look at a page if it is held in the buffer pool, leaving the replacer alone.
+   * @param page_id id of page
+   * @param reader called with the page, which it must latch to read
+   * @return false if the page is not held in the buffer pool
+   */
+  bool PeekResidentPage(page_id_t page_id, const std::function<void(Page *)> &reader) override;
+
+  /**
+   * Drop the ring of the strategy, waiting for a prefetch that is loading a page into it.
+   * @param strategy_id id of the strategy being destroyed
+   */
+  void ReleaseAccessStrategy(uint64_t strategy_id) override;
+
  protected:
   /**
    * Fetch the requested page from the buffer pool.
@@ -96,23 +180,282 @@ class BufferPoolManagerInstance : public BufferPoolManager {
   bool DeletePgImp(page_id_t page_id) override;
 
   /**
-   * Flushes all the pages in the buffer pool to disk.
+   * Flushes all the dirty pages in the buffer pool to disk, in page id order with a single flush of the file.
    */
   void FlushAllPgsImp() override;
 
   /**
-   * Allocate a page on disk.∂
+   * Fetch the requested page, loading it into a frame of the strategy's ring on a miss.
+   * @param page_id id of page to be fetched
+   * @param strategy access strategy of the operation, nullptr to take victims from the shared replacer
+   * @return the requested page
+   */
+  Page *FetchPgWithStrategyImp(page_id_t page_id, BufferAccessStrategy *strategy) override;
+
+  /**
+   * Fetch several pages, pinning the resident ones without the latch and loading the misses under a single
+   * acquisition of it, read from disk together in page id order.
+   * @param page_ids ids of the pages to be fetched
+   * @param[out] pages the fetched pages, nullptr for a page there was no frame for
+   * @return true if every page was fetched
+   */
+  bool FetchPgsImp(const std::vector<page_id_t> &page_ids, Page **pages) override;
+
+  /**
+   * Fetch the page a swip references. A swizzled swip whose frame still holds the page pins it without the page table
+   * lookup, otherwise the page is fetched by id and the swip swizzled to its frame.
+   * @param swip reference to the page to be fetched
+   * @return the requested page
+   */
+  Page *FetchPgSwizzledImp(Swip *swip) override;
+
+  /**
+   * Creates a new page in a frame of the strategy's ring.
+   * @param[out] page_id id of created page
+   * @param strategy access strategy of the operation, nullptr to take victims from the shared replacer
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  Page *NewPgWithStrategyImp(page_id_t *page_id, BufferAccessStrategy *strategy) override;
+
+  /**
+   * Creates a new page, preferring a page id close to the hint.
+   * @param[out] page_id id of created page
+   * @param hint id of a page the new page should be close to, INVALID_PAGE_ID for none
+   * @param strategy access strategy of the operation, nullptr to take victims from the shared replacer
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  Page *NewPgNearImp(page_id_t *page_id, page_id_t hint, BufferAccessStrategy *strategy) override;
+
+  /**
+   * Queue the page to be loaded by the prefetch thread, starting the thread on first use.
+   * @param page_id id of page to be prefetched
+   * @param strategy access strategy of the operation the page is prefetched for, if any
+   */
+  void PrefetchPgImp(page_id_t page_id, BufferAccessStrategy *strategy) override;
+
+  /** Body of the prefetch thread, loads queued pages until the instance is destroyed. */
+  void PrefetchLoop();
+
+  /** Body of the background writer, cleans the victim end of the replacer until the instance is destroyed. */
+  void BackgroundWriterLoop();
+
+  /**
+   * Write back the dirty pages among the next frames the replacer would victimize, in page id order, so that misses
+   * find clean victims. Pinned pages are left alone, and so are pages whose log records are not durable yet, the
+   * writer does not wait for the log.
+   * @param max_frames how many frames at the victim end to look at
+   * @return the number of pages written
+   */
+  size_t CleanVictimFrames(size_t max_frames);
+
+  /** A page hint waiting in the prefetch queue. */
+  struct PrefetchRequest {
+    page_id_t page_id_;
+    /** Id of the strategy the page is loaded for, 0 if the page goes to the shared pool. */
+    uint64_t strategy_id_;
+    BufferAccessStrategyType strategy_type_;
+  };
+
+  /**
+   * Load the page into an unpinned frame unless it is already resident. Pages that never get fetched are the first
+   * to go, the replacer does not count the load as an access.
+   * @param request the page to be loaded and the strategy it is loaded for
+   * @param free_frame_only true to only use a free frame rather than evicting another page
+   * @return false if there was no frame to load the page into, or the page is corrupt
+   */
+  bool LoadPage(const PrefetchRequest &request, bool free_frame_only = false);
+
+  /** A resident page as saved in the dump, with its rank in the replacer. Hotter pages have higher ranks. */
+  using DumpEntry = std::pair<page_id_t, uint32_t>;
+
+  /**
+   * Read the dump a previous instance left behind, keeping the pages this instance is responsible for.
+   * @param[out] entries the saved pages
+   * @return false if there is no usable dump
+   */
+  bool ReadDump(std::vector<DumpEntry> *entries);
+
+  /**
+   * Body of the warm-up thread. Loads the hottest saved pages that fit into the free frames in page id order, so that
+   * the reads are mostly sequential, then orders them in the replacer by their saved hotness. Traffic is served
+   * meanwhile and warming up never evicts a page.
+   * @param entries the saved pages
+   */
+  void WarmUp(std::vector<DumpEntry> entries);
+
+  /** Frames an access strategy recycles, with the page each of them was last loaded with. */
+  struct BufferRing {
+    BufferAccessStrategyType type_;
+    /** Number of frames the ring grows to before it starts recycling them. */
+    size_t size_;
+    std::vector<std::pair<frame_id_t, page_id_t>> slots_;
+    /** Slot to be recycled next once the ring is full. */
+    size_t next_{0};
+  };
+
+  /**
+   * Look up the ring of a strategy in this instance, creating it on first use. Must be called with latch_ held.
+   * @param strategy_id id of the strategy, 0 for none
+   * @param type the kind of bulk operation
+   * @return the ring of the strategy, or nullptr if there is no strategy
+   */
+  BufferRing *GetRing(uint64_t strategy_id, BufferAccessStrategyType type);
+
+  /**
+   * Remember that the frame now holds the page on behalf of the ring. Must be called with latch_ held.
+   * @param ring ring the frame was taken for, may be nullptr
+   * @param frame_id the frame
+   * @param page_id the page loaded into the frame
+   */
+  void AddToRing(BufferRing *ring, frame_id_t frame_id, page_id_t page_id);
+
+  /** A pin count transition between zero and one the replacer has yet to hear about. */
+  struct QueuedAccess {
+    /** Position of the transition among those of all stripes. */
+    uint64_t seq_;
+    frame_id_t frame_id_;
+    /** Generation of the frame at the time, transitions of a page that has left the frame since are dropped. */
+    uint32_t generation_;
+    /** True for a first pin, false for a last unpin. */
+    bool pinned_;
+  };
+
+  /**
+   * A slice of the page table with its own latch, so lookups of unrelated pages do not contend. Pins and unpins of its
+   * pages are queued in accesses_ and handed to the replacer in batches, so that hits do not take the replacer's latch.
+   */
+  struct alignas(64) PageTableStripe {
+    std::mutex latch_;
+    std::unordered_map<page_id_t, frame_id_t> table_;
+    std::vector<QueuedAccess> accesses_;
+  };
+
+  /** Number of page table stripes. */
+  static constexpr size_t PAGE_TABLE_STRIPES = 16;
+  /** Number of transitions a stripe queues before handing them to the replacer itself. */
+  static constexpr size_t MAX_QUEUED_ACCESSES = 64;
+
+  /** @return the page table stripe responsible for the given page id */
+  PageTableStripe &StripeOf(page_id_t page_id) { return page_table_[(page_id / num_instances_) % PAGE_TABLE_STRIPES]; }
+
+  /**
+   * Pin the page if it is resident. This is the hit path and only takes the latch of one page table stripe.
+   * @param page_id id of page to be pinned
+   * @return the pinned page, or nullptr if the page is not in the buffer pool
+   */
+  Page *PinIfResident(page_id_t page_id);
+
+  /**
+   * Pin the page in a frame if the frame still holds it, without looking the page up.
+   * @param page_id id of page
+   * @param frame_id frame the page was in
+   * @param generation generation of the frame at the time
+   * @return the pinned page, nullptr if the page has left the frame since
+   */
+  Page *PinIfInFrame(page_id_t page_id, frame_id_t frame_id, uint32_t generation);
+
+  /**
+   * Queue a pin count transition of a frame for the replacer. Caller holds the latch of the stripe.
+   * @param stripe the page table stripe of the page in the frame
+   * @param frame_id the frame
+   * @param pinned true if the pin count just went from zero to one, false if it just dropped to zero
+   */
+  void QueueAccess(PageTableStripe *stripe, frame_id_t frame_id, bool pinned);
+
+  /**
+   * Replay queued transitions on the replacer, in order. Caller holds the latches of the stripes they come from.
+   * @param accesses the transitions
+   */
+  void ApplyAccesses(const std::vector<QueuedAccess> &accesses);
+
+  /**
+   * Hand the queued transitions of every stripe to the replacer, so that it picks victims knowing about all of them.
+   * Must be called with latch_ held.
+   */
+  void ApplyAllAccesses();
+
+  /**
+   * Keep a resident page from being evicted without it counting as an access for the replacer.
+   * Caller holds the latch of the page table stripe of the page.
+   * @param page the page
+   */
+  void PinQuietly(Page *page);
+
+  /**
+   * Undo PinQuietly().
+   * @param page_id id of the page
+   * @param frame_id frame holding the page
+   */
+  void UnpinQuietly(page_id_t page_id, frame_id_t frame_id);
+
+  /**
+   * Find a frame to hold a new page, preferring the free list over the replacer. A dirty victim is written back and
+   * removed from the page table. Must be called with latch_ held.
+   * @param[out] frame_id id of the frame that can be reused
+   * @return false if every frame is pinned, true otherwise
+   */
+  bool FindVictimFrame(frame_id_t *frame_id);
+
+  /**
+   * Find a frame for a page loaded on behalf of a ring. Once the ring is full its next frame is recycled if it still
+   * holds the page the ring put there and nobody is using it, otherwise a victim is found as usual. Bulk reads leave
+   * dirty frames to the regular path. Must be called with latch_ held.
+   * @param ring ring of the strategy, nullptr to take a victim from the shared replacer
+   * @param[out] frame_id id of the frame that can be reused
+   * @return false if every frame is pinned, true otherwise
+   */
+  bool FindVictimFrame(BufferRing *ring, frame_id_t *frame_id);
+
+  /**
+   * Evict the pages held by a range of frames, skipping pinned ones. Must be called with latch_ held.
+   * @param begin first frame of the range
+   * @param end frame past the range
+   * @return true if every frame of the range is empty now
+   */
+  bool DrainFrames(size_t begin, size_t end);
+
+  /** @return the size of the memory holding pages_, rounded up to whole pages */
+  inline size_t PagesSize() const { return (max_pool_size_ * sizeof(Page) + PAGE_SIZE - 1) / PAGE_SIZE * PAGE_SIZE; }
+
+  /**
+   * Allocate a page on disk, reusing a deallocated one if there is any.
+   * @param hint id of a page the new page should be close to, INVALID_PAGE_ID for none
    * @return the id of the allocated page
    */
-  page_id_t AllocatePage();
+  page_id_t AllocatePage(page_id_t hint = INVALID_PAGE_ID);
 
   /**
    * Deallocate a page on disk.
    * @param page_id id of the page to deallocate
    */
-  void DeallocatePage(__attribute__((unused)) page_id_t page_id) {
-    // This is a no-nop right now without a more complex data structure to track deallocated pages
-  }
+  void DeallocatePage(page_id_t page_id) { free_page_map_->Deallocate(page_id); }
+
+  /**
+   * Read a page into a frame, from the compressed tier if it holds the page, otherwise from disk.
+   * @param page_id id of the page
+   * @param data the PAGE_SIZE bytes of the frame
+   */
+  void ReadPage(page_id_t page_id, char *data);
+
+  /**
+   * Give back a frame taken for a page whose read failed, before the page was published. Must be called with latch_
+   * held.
+   * @param frame_id id of the frame
+   */
+  void DiscardFrame(frame_id_t frame_id);
+
+  /**
+   * Write-ahead logging: a page may only be written once the log is durable up to the last record that changed it.
+   * @param page the page
+   * @return the LSN the log has to be durable up to before the page is written, INVALID_LSN if it already is
+   */
+  lsn_t UnloggedLSN(Page *page);
+
+  /**
+   * Wait until the page may be written, making the log durable up to its last record if needed.
+   * @param page the page
+   */
+  void FlushLogFor(Page *page);
 
   /**
    * Validate that the page_id being used is accessible to this BPI. This can be used in all of the functions to
@@ -121,28 +464,97 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    */
   void ValidatePageId(page_id_t page_id) const;
 
-  /** Number of pages in the buffer pool. */
-  const size_t pool_size_;
+  /** Number of pages in the buffer pool. Frames at or past it are not handed out, they are being drained. */
+  std::atomic<size_t> pool_size_;
+  /** Number of frames there is room for, the size the buffer pool may grow to. */
+  const size_t max_pool_size_;
   /** How many instances are in the parallel BPM (if present, otherwise just 1 BPI) */
   const uint32_t num_instances_ = 1;
   /** Index of this BPI in the parallel BPM (if present, otherwise just 0) */
   const uint32_t instance_index_ = 0;
-  /** Each BPI maintains its own counter for page_ids to hand out, must ensure they mod back to its instance_index_ */
-  std::atomic<page_id_t> next_page_id_ = instance_index_;
+  /** NUMA node the memory of the buffer pool is placed on, -1 for none */
+  const int numa_node_;
+  /** Each BPI hands out its own page_ids, they mod back to its instance_index_. Saved next to the database file. */
+  FreePageMap *free_page_map_;
 
-  /** Array of buffer pool pages. */
+  /**
+   * Array of buffer pool pages, max_pool_size_ long. Holds the book-keeping of every frame, the data is in
+   * frame_arena_.
+   */
   Page *pages_;
+  /** Page aligned memory holding the data of every frame. */
+  FrameArena *frame_arena_;
+  /** Clean pages evicted from the buffer pool, compressed. nullptr if compressed_page_cache_size was 0. */
+  CompressedPageCache *compressed_cache_{nullptr};
   /** Pointer to the disk manager. */
-  DiskManager *disk_manager_ __attribute__((__unused__));
+  DiskManager *disk_manager_;
   /** Pointer to the log manager. */
-  LogManager *log_manager_ __attribute__((__unused__));
-  /** Page table for keeping track of buffer pool pages. */
-  std::unordered_map<page_id_t, frame_id_t> page_table_;
+  LogManager *log_manager_;
+  /**
+   * Page table for keeping track of buffer pool pages, striped by page id. A stripe latch protects its entries and
+   * orders pin count transitions between zero and one with the queue of transitions the replacer has yet to see.
+   */
+  std::array<PageTableStripe, PAGE_TABLE_STRIPES> page_table_;
   /** Replacer to find unpinned pages for replacement. */
   Replacer *replacer_;
+  /** Source of QueuedAccess::seq_. */
+  std::atomic<uint64_t> next_access_seq_{0};
+  /** Number of frames with a pin count above zero, counted as pages are pinned for the first time and unpinned. */
+  std::atomic<size_t> num_pinned_frames_{0};
   /** List of free pages. */
   std::list<frame_id_t> free_list_;
-  /** This latch protects shared data structures. We recommend updating this comment to describe what it protects. */
+  /**
+   * This latch serializes the slow paths: misses, evictions, new pages, deletes and flushes. It protects free_list_
+   * and the page id and contents of frames while they change hands. Hits and unpins never take it.
+   * Lock order is latch_, then a stripe latch, then the replacer's internal latch.
+   */
   std::mutex latch_;
+  /** Serializes ResizePool calls. Taken before latch_. */
+  std::mutex resize_latch_;
+
+  /** Maximum number of queued prefetch hints, further hints are dropped. */
+  static constexpr size_t PREFETCH_QUEUE_SIZE = 64;
+  /** Pages waiting to be prefetched, in the order they were hinted. */
+  std::deque<PrefetchRequest> prefetch_queue_;
+  /** Strategy of the request the prefetch thread is loading right now, 0 if none. */
+  uint64_t prefetch_loading_strategy_{0};
+  /** Background thread loading prefetched pages, started by the first hint. */
+  std::thread *prefetch_thread_{nullptr};
+  /** Tells the prefetch thread to exit. */
+  bool stop_prefetch_{false};
+  /** Protects prefetch_queue_, prefetch_loading_strategy_, prefetch_thread_ and stop_prefetch_. */
+  std::mutex prefetch_latch_;
+  /** Wakes the prefetch thread up when a hint is queued or the instance shuts down. */
+  std::condition_variable prefetch_cv_;
+  /** Signalled whenever the prefetch thread finishes loading a page. */
+  std::condition_variable prefetch_done_cv_;
+
+  /** Rings of the access strategies that loaded pages through this instance, by strategy id. Protected by latch_. */
+  std::unordered_map<uint64_t, BufferRing> rings_;
+
+  /** Marks a dump file, followed by the number of entries and the entries. */
+  static constexpr uint32_t DUMP_MAGIC = 0x50554d44;
+  /** File the resident pages are saved to. */
+  std::string dump_file_name_;
+  /** Serializes writers of the dump file. */
+  std::mutex dump_latch_;
+  /** When the background writer saved the resident pages last. */
+  std::chrono::steady_clock::time_point last_dump_;
+  /** Background thread loading the pages of the last dump, if there was one. */
+  std::thread *warm_up_thread_{nullptr};
+  /** Tells the warm-up thread to stop early. */
+  std::atomic<bool> stop_warm_up_{false};
+
+  /** What the buffer pool has been doing. */
+  BufferPoolStats stats_;
+
+  /** Background thread writing back dirty pages before they are victimized. */
+  std::thread *bg_writer_thread_;
+  /** Tells the background writer to exit. */
+  bool stop_bg_writer_{false};
+  /** Protects stop_bg_writer_. */
+  std::mutex bg_writer_latch_;
+  /** Wakes the background writer up early, e.g. when a miss had to write back its victim itself. */
+  std::condition_variable bg_writer_cv_;
 };
 }  // namespace bustub
@@ -0,0 +1,127 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_stats.h
+//
+// Identification: src/include/buffer/buffer_pool_stats.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cstdint>
+
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * A point in time copy of the statistics of a buffer pool. Snapshots of several buffer pools add up.
+ */
+struct BufferPoolStatsSnapshot {
+  /** Number of buckets of the miss latency histogram. */
+  static constexpr size_t NUM_LATENCY_BUCKETS = 24;
+
+  /** Page requests served from a frame. */
+  uint64_t hits_{0};
+  /** Page requests that had to read the page from disk. */
+  uint64_t misses_{0};
+  /** Pages evicted to make room for another page. */
+  uint64_t evictions_{0};
+  /** Dirty victims written back by the thread that needed their frame. */
+  uint64_t dirty_writebacks_{0};
+  /** Dirty pages written back ahead of time by the background writer. */
+  uint64_t background_writes_{0};
+  /** Page requests that failed because every frame was pinned. */
+  uint64_t pin_waits_{0};
+  /**
+   * Latency of FetchPage misses. Bucket 0 counts misses under 1 us, bucket i those from 2^(i-1) up to 2^i us, the last
+   * bucket everything longer. Misses of batched fetches are only in misses_.
+   */
+  std::array<uint64_t, NUM_LATENCY_BUCKETS> miss_latency_histogram_{};
+  /** Misses served from the compressed tier instead of disk. */
+  uint64_t compressed_hits_{0};
+  /** Misses the compressed tier could not serve. */
+  uint64_t compressed_misses_{0};
+  /** Bytes of memory held by the compressed tier right now. */
+  uint64_t compressed_bytes_{0};
+
+  /** @return the share of page requests that were hits, 0 if there were none */
+  double HitRatio() const {
+    return hits_ + misses_ == 0 ? 0 : static_cast<double>(hits_) / static_cast<double>(hits_ + misses_);
+  }
+
+  /** @return the share of misses the compressed tier served, 0 if it was never asked */
+  double CompressedHitRatio() const {
+    return compressed_hits_ + compressed_misses_ == 0
+               ? 0
+               : static_cast<double>(compressed_hits_) / static_cast<double>(compressed_hits_ + compressed_misses_);
+  }
+
+  /**
+   * @param percentile between 0 and 100
+   * @return upper bound in microseconds of the histogram bucket the percentile of miss latencies falls in, 0 if there
+   * were no misses
+   */
+  uint64_t MissLatencyPercentile(double percentile) const;
+
+  /** Add the statistics of another buffer pool. */
+  BufferPoolStatsSnapshot &operator+=(const BufferPoolStatsSnapshot &other);
+};
+
+/**
+ * BufferPoolStats counts what a buffer pool does. Counting is lock-free and cheap enough for the hit path: every
+ * counter is split into shards on separate cache lines and each thread only adds to its own shard, so threads never
+ * fight over a line. A snapshot sums up the shards.
+ */
+class BufferPoolStats {
+ public:
+  BufferPoolStats() = default;
+  DISALLOW_COPY_AND_MOVE(BufferPoolStats);
+
+  inline void AddHit() { Shard().hits_.fetch_add(1, std::memory_order_relaxed); }
+  inline void AddMiss() { Shard().misses_.fetch_add(1, std::memory_order_relaxed); }
+  inline void AddEviction() { Shard().evictions_.fetch_add(1, std::memory_order_relaxed); }
+  inline void AddDirtyWriteback() { Shard().dirty_writebacks_.fetch_add(1, std::memory_order_relaxed); }
+  inline void AddBackgroundWrite() { Shard().background_writes_.fetch_add(1, std::memory_order_relaxed); }
+  inline void AddPinWait() { Shard().pin_waits_.fetch_add(1, std::memory_order_relaxed); }
+
+  /**
+   * Count a miss and how long it took.
+   * @param latency time from the request to the page being read
+   */
+  void AddMiss(std::chrono::nanoseconds latency);
+
+  /** @return the sum of all shards. Counts made while the snapshot is taken may or may not be in it. */
+  BufferPoolStatsSnapshot GetSnapshot() const;
+
+ private:
+  /** Number of shards. Threads beyond it share shards, which is still correct, just slower. */
+  static constexpr size_t NUM_SHARDS = 16;
+
+  struct alignas(64) StatsShard {
+    std::atomic<uint64_t> hits_{0};
+    std::atomic<uint64_t> misses_{0};
+    std::atomic<uint64_t> evictions_{0};
+    std::atomic<uint64_t> dirty_writebacks_{0};
+    std::atomic<uint64_t> background_writes_{0};
+    std::atomic<uint64_t> pin_waits_{0};
+    std::array<std::atomic<uint64_t>, BufferPoolStatsSnapshot::NUM_LATENCY_BUCKETS> miss_latency_histogram_{};
+  };
+
+  /** @return the shard of the calling thread */
+  inline StatsShard &Shard() { return shards_[ThreadShard()]; }
+
+  /** @return the shard index of the calling thread, handed out round robin when the thread first counts anything */
+  static size_t ThreadShard();
+
+  std::array<StatsShard, NUM_SHARDS> shards_;
+};
+
+}  // namespace bustub
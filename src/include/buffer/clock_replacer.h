@@ -12,7 +12,6 @@
 
 #pragma once
 
-#include <list>
 #include <mutex>  // NOLINT
 #include <vector>
 
@@ -23,6 +22,10 @@ namespace bustub {
 
 /**
  * ClockReplacer implements the clock replacement policy, which approximates the Least Recently Used policy.
+ *
+ * Every frame has a slot on the clock. An unpinned frame is in the clock with its reference bit set. The clock hand
+ * sweeps over the slots, clearing reference bits, and victimizes the first frame in the clock whose bit is already
+ * clear. Frames unpinned since the hand last passed them therefore survive one more round.
  */
 class ClockReplacer : public Replacer {
  public:
@@ -43,10 +46,21 @@ class ClockReplacer : public Replacer {
 
   void Unpin(frame_id_t frame_id) override;
 
+  void PeekVictims(size_t max_frames, std::vector<frame_id_t> *frame_ids) override;
+
   size_t Size() override;
 
  private:
-  // TODO(student): implement me!
+  /** True for the frames that are in the clock, i.e. unpinned. */
+  std::vector<bool> in_clock_;
+  /** Reference bit of every frame, only meaningful while the frame is in the clock. */
+  std::vector<bool> ref_;
+  /** Slot the clock hand points at. */
+  size_t hand_{0};
+  /** Number of frames in the clock. */
+  size_t size_{0};
+  /** Protects all of the above. */
+  std::mutex latch_;
 };
 
 }  // namespace bustub
@@ -0,0 +1,104 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// compressed_page_cache.h
+//
+// Identification: src/include/buffer/compressed_page_cache.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <list>
+#include <mutex>  // NOLINT
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * CompressedPageCache is a second tier of memory behind a buffer pool. Clean pages evicted from the buffer pool are
+ * kept compressed, and a miss in the buffer pool looks here before going to disk, so a working set somewhat larger
+ * than the buffer pool costs a decompression per miss instead of an I/O.
+ *
+ * The cache is exclusive: a page leaves it when it is loaded back into the buffer pool, so it is never stale. When
+ * full, the least recently inserted pages are dropped; they are on disk already.
+ */
+class CompressedPageCache {
+ public:
+  /**
+   * Creates a new CompressedPageCache.
+   * @param capacity number of bytes of compressed pages the cache holds at most
+   */
+  explicit CompressedPageCache(size_t capacity);
+
+  DISALLOW_COPY_AND_MOVE(CompressedPageCache);
+
+  /**
+   * Compress a page into the cache, dropping the oldest pages if it is full. Pages that hardly compress are not kept.
+   * The page has to be the same as on disk.
+   * @param page_id id of the page
+   * @param data the PAGE_SIZE bytes of the page
+   * @return true if the page was kept
+   */
+  bool Insert(page_id_t page_id, const char *data);
+
+  /**
+   * Take a page out of the cache.
+   * @param page_id id of the page
+   * @param[out] data buffer of PAGE_SIZE bytes for the page
+   * @return false if the page is not in the cache
+   */
+  bool Take(page_id_t page_id, char *data);
+
+  /**
+   * Drop a page, e.g. because it was deleted.
+   * @param page_id id of the page
+   */
+  void Remove(page_id_t page_id);
+
+  /** @return number of Take calls that found their page */
+  uint64_t GetHits();
+
+  /** @return number of Take calls that did not find their page */
+  uint64_t GetMisses();
+
+  /** @return number of bytes of compressed pages held */
+  size_t GetMemoryUsed();
+
+  /** @return number of pages held */
+  size_t GetNumPages();
+
+ private:
+  /** Pages that do not compress to at most this many bytes are not worth keeping. */
+  static constexpr size_t MAX_COMPRESSED_SIZE = PAGE_SIZE - PAGE_SIZE / 8;
+
+  struct CachedPage {
+    std::vector<char> data_;
+    std::list<page_id_t>::iterator position_;
+  };
+
+  /** Drop a page from the cache. Must be called with latch_ held. */
+  void Erase(std::unordered_map<page_id_t, CachedPage>::iterator it);
+
+  const size_t capacity_;
+  /** Compressed pages by page id. */
+  std::unordered_map<page_id_t, CachedPage> pages_;
+  /** Page ids from the least to the most recently inserted. */
+  std::list<page_id_t> order_;
+  size_t memory_used_{0};
+  uint64_t hits_{0};
+  uint64_t misses_{0};
+  /** Scratch space to compress into. */
+  char buffer_[MAX_COMPRESSED_SIZE];
+  std::mutex latch_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,85 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_arena.h
+//
+// Identification: src/include/buffer/frame_arena.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * FrameArena is the memory holding the data of all frames of a buffer pool, as one page aligned region. Pools of at
+ * least a huge page are backed by 2 MB huge pages when the system has them reserved, or otherwise aligned to a huge
+ * page and handed to transparent huge pages, which cuts TLB misses for large pools.
+ *
+ * An arena can be given room to grow: address space for max_frames is reserved up front, but only the first
+ * num_frames frames are accessible and take up memory. Growing and shrinking never moves existing frames.
+ *
+ * On NUMA systems the arena can be placed on a node, the memory is then allocated from that node as frames are touched.
+ */
+class FrameArena {
+ public:
+  /** Size of the huge pages the arena asks for. */
+  static constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+  /**
+   * Map a zeroed region for the frames.
+   * @param num_frames number of PAGE_SIZE frames in the arena
+   * @param max_frames number of frames the arena may grow to, no growth if it is not larger than num_frames
+   * @param numa_node NUMA node to place the frames on, -1 to leave it to the system
+   */
+  explicit FrameArena(size_t num_frames, size_t max_frames = 0, int numa_node = -1);
+
+  /**
+   * Unmap the region.
+   */
+  ~FrameArena();
+
+  DISALLOW_COPY_AND_MOVE(FrameArena);
+
+  /**
+   * @param frame_id index of a frame
+   * @return the PAGE_SIZE bytes of data of the frame, aligned to PAGE_SIZE
+   */
+  inline char *GetFrameData(size_t frame_id) { return data_ + frame_id * PAGE_SIZE; }
+
+  /** @return true if the arena is backed by explicitly reserved huge pages */
+  inline bool IsHugePageBacked() const { return huge_pages_; }
+
+  /** @return the number of frames the arena may grow to */
+  inline size_t GetMaxFrames() const { return max_frames_; }
+
+  /**
+   * Change the number of accessible frames. Frames cut off are zeroed and their memory is given back to the system,
+   * except for arenas in reserved huge pages, which keep their memory.
+   * @param num_frames the new number of frames, at most GetMaxFrames()
+   * @return false if the frames could not be made accessible
+   */
+  bool Resize(size_t num_frames);
+
+ private:
+  /** Start of the frames. */
+  char *data_{nullptr};
+  /** Number of bytes mapped at data_. */
+  size_t mapped_size_{0};
+  /** Number of accessible frames. */
+  size_t num_frames_;
+  /** Number of frames there is address space for. */
+  size_t max_frames_;
+  /** True if the mapping came from the reserved huge page pool. */
+  bool huge_pages_{false};
+};
+
+}  // namespace bustub
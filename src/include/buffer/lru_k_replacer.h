@@ -0,0 +1,102 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lru_k_replacer.h
+//
+// Identification: src/include/buffer/lru_k_replacer.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <deque>
+#include <mutex>  // NOLINT
+#include <set>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "buffer/replacer.h"
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * LRUKReplacer implements the LRU-K replacement policy.
+ *
+ * Every Pin() counts as an access and the replacer remembers the timestamps of the last K accesses of each frame.
+ * The victim is the unpinned frame with the largest backward K-distance, i.e. the one whose K-th most recent access
+ * lies furthest in the past. Frames with fewer than K accesses have an infinite backward K-distance and are evicted
+ * first, oldest first access first. Pages touched once by a sequential scan therefore never push out pages that
+ * have been referenced K times. A frame that is unpinned without ever being pinned, e.g. a prefetched page, is
+ * evictable but has no accesses yet; it is ordered by the time it was unpinned.
+ */
+class LRUKReplacer : public Replacer {
+ public:
+  /**
+   * Create a new LRUKReplacer.
+   * @param num_pages the maximum number of pages the LRUKReplacer will be required to store
+   * @param k the number of accesses to remember for each frame
+   */
+  explicit LRUKReplacer(size_t num_pages, size_t k = LRUK_REPLACER_K);
+
+  /**
+   * Destroys the LRUKReplacer.
+   */
+  ~LRUKReplacer() override;
+
+  bool Victim(frame_id_t *frame_id) override;
+
+  void Pin(frame_id_t frame_id) override;
+
+  void Unpin(frame_id_t frame_id) override;
+
+  void Remove(frame_id_t frame_id) override;
+
+  void PeekVictims(size_t max_frames, std::vector<frame_id_t> *frame_ids) override;
+
+  size_t Size() override;
+
+ private:
+  /** Access history of a single frame. */
+  struct FrameEntry {
+    /** Timestamps of the last (at most) k_ accesses, oldest first. */
+    std::deque<uint64_t> history_;
+    /** When the frame was unpinned without any recorded access. */
+    uint64_t admitted_{0};
+    /** True if the frame is unpinned and can be victimized. */
+    bool evictable_{false};
+  };
+
+  using EvictKey = std::pair<uint64_t, frame_id_t>;
+
+  /** @return the key ordering an evictable frame within its eviction set */
+  EvictKey KeyOf(frame_id_t frame_id, const FrameEntry &entry) const {
+    return {entry.history_.empty() ? entry.admitted_ : entry.history_.front(), frame_id};
+  }
+
+  /** @return the eviction set the frame belongs to, depending on how many accesses it has seen */
+  std::set<EvictKey> *SetOf(const FrameEntry &entry) {
+    return entry.history_.size() < k_ ? &infinite_set_ : &finite_set_;
+  }
+
+  /** Record an access to the frame at the current logical time. */
+  void RecordAccess(FrameEntry *entry);
+
+  const size_t k_;
+  /** Logical clock, bumped on every access. */
+  uint64_t current_timestamp_{0};
+  /** Every frame that has been accessed since it was last victimized. */
+  std::unordered_map<frame_id_t, FrameEntry> entries_;
+  /** Evictable frames with fewer than k_ accesses, ordered by their first access. */
+  std::set<EvictKey> infinite_set_;
+  /** Evictable frames with k_ accesses, ordered by their k-th most recent access. */
+  std::set<EvictKey> finite_set_;
+  /** Protects all of the above. */
+  std::mutex latch_;
+};
+
+}  // namespace bustub
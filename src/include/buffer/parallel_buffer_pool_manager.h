@@ -12,7 +12,11 @@
 
 #pragma once
 
+#include <atomic>
+#include <vector>
+
 #include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_manager_instance.h"
 #include "recovery/log_manager.h"
 #include "storage/disk/disk_manager.h"
 #include "storage/page/page.h"
@@ -27,9 +31,14 @@ class ParallelBufferPoolManager : public BufferPoolManager {
    * @param pool_size the pool size of each BufferPoolManagerInstance
    * @param disk_manager the disk manager
    * @param log_manager the log manager (for testing only: nullptr = disable logging)
+   * @param replacer_type the replacement policy of every BufferPoolManagerInstance
+   * @param max_pool_size the pool size each BufferPoolManagerInstance may grow to at runtime
+   *
+   * On NUMA systems the instances are spread over the nodes, instance i is placed on node i % number of nodes.
    */
   ParallelBufferPoolManager(size_t num_instances, size_t pool_size, DiskManager *disk_manager,
-                            LogManager *log_manager = nullptr);
+                            LogManager *log_manager = nullptr, ReplacerType replacer_type = ReplacerType::LRU,
+                            size_t max_pool_size = 0);
 
   /**
    * Destroys an existing ParallelBufferPoolManager.
@@ -39,6 +48,44 @@ class ParallelBufferPoolManager : public BufferPoolManager {
   /** @return size of the buffer pool */
   size_t GetPoolSize() override;
 
+  /**
+   * Grow or shrink every instance while the buffer pool is in use. The number of instances stays fixed: page ids are
+   * partitioned among the instances by page_id % num_instances, so adding or removing one would re-home most pages.
+   * @param pool_size the new total number of frames, spread evenly over the instances
+   * @return false if some instance could not be resized, the instances resized before it are then put back to their
+   * old size
+   */
+  bool ResizePool(size_t pool_size);
+
+  /**
+   * @param page_id id of page
+   * @return true if the page is currently held by the responsible BufferPoolManagerInstance
+   */
+  bool IsResident(page_id_t page_id) override;
+
+  /**
+   * Look at a page if the responsible BufferPoolManagerInstance holds it.
+   * @param page_id id of page
+   * @param reader called with the page, which it must latch to read
+   * @return false if the page is not held in the buffer pool
+   */
+  bool PeekResidentPage(page_id_t page_id, const std::function<void(Page *)> &reader) override;
+
+  /** @return the statistics of all instances added up */
+  BufferPoolStatsSnapshot GetStats() override;
+
+  /**
+   * @return the number of fetched and created pages that were held by an instance on another NUMA node than the thread
+   * asking for them. Always 0 on systems with a single node.
+   */
+  uint64_t GetRemoteAccessCount() const { return remote_accesses_; }
+
+  /**
+   * Forget the rings the strategy has in any of the instances.
+   * @param strategy_id id of the strategy being destroyed
+   */
+  void ReleaseAccessStrategy(uint64_t strategy_id) override;
+
  protected:
   /**
    * @param page_id id of page
@@ -46,6 +93,33 @@ class ParallelBufferPoolManager : public BufferPoolManager {
    */
   BufferPoolManager *GetBufferPoolManager(page_id_t page_id);
 
+  /**
+   * Count an access to an instance if it is on another NUMA node than the calling thread.
+   * @param instance index of the instance
+   */
+  void CountAccess(size_t instance);
+
+  /**
+   * Create a new page in the instance with the most unpinned frames, going by their approximate occupancy. Instances
+   * that are equally occupied take turns, and instances with every frame pinned are not tried at all. With
+   * enable_numa_local_allocation the instances on the node of the calling thread are tried first.
+   * @param[out] page_id id of created page
+   * @param strategy access strategy of the operation, if any
+   * @return nullptr if no instance has room
+   */
+  Page *NewPageLeastOccupied(page_id_t *page_id, BufferAccessStrategy *strategy);
+
+  /**
+   * Create a new page in one of the candidate instances, trying them from the least to the most occupied.
+   * @param candidates indexes of the instances to choose from
+   * @param start turn of the call, decides between equally occupied instances
+   * @param[out] page_id id of created page
+   * @param strategy access strategy of the operation, if any
+   * @return nullptr if none of the candidates has room
+   */
+  Page *NewPageIn(const std::vector<size_t> &candidates, size_t start, page_id_t *page_id,
+                  BufferAccessStrategy *strategy);
+
   /**
    * Fetch the requested page from the buffer pool.
    * @param page_id id of page to be fetched
@@ -83,8 +157,69 @@ class ParallelBufferPoolManager : public BufferPoolManager {
   bool DeletePgImp(page_id_t page_id) override;
 
   /**
-   * Flushes all the pages in the buffer pool to disk.
+   * Flushes the dirty pages of all instances to disk together, in page id order with a single flush of the file.
    */
   void FlushAllPgsImp() override;
+
+  /**
+   * Fetch the requested page through the strategy's ring in the responsible BufferPoolManagerInstance.
+   * @param page_id id of page to be fetched
+   * @param strategy access strategy of the operation
+   * @return the requested page
+   */
+  Page *FetchPgWithStrategyImp(page_id_t page_id, BufferAccessStrategy *strategy) override;
+
+  /**
+   * Fetch the page a swip references through the responsible BufferPoolManagerInstance.
+   * @param swip reference to the page to be fetched
+   * @return the requested page
+   */
+  Page *FetchPgSwizzledImp(Swip *swip) override;
+
+  /**
+   * Split the batch by responsible BufferPoolManagerInstance and fetch each part in one go.
+   * @param page_ids ids of the pages to be fetched
+   * @param[out] pages the fetched pages, nullptr for a page that could not be fetched
+   * @return true if every page was fetched
+   */
+  bool FetchPgsImp(const std::vector<page_id_t> &page_ids, Page **pages) override;
+
+  /**
+   * Creates a new page in the strategy's ring of one of the instances, picked by occupancy like NewPgImp.
+   * @param[out] page_id id of created page
+   * @param strategy access strategy of the operation
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  Page *NewPgWithStrategyImp(page_id_t *page_id, BufferAccessStrategy *strategy) override;
+
+  /**
+   * Creates a new page in the instance owning the hint, next to it, falling back to any instance like NewPgImp if
+   * that instance is full.
+   * @param[out] page_id id of created page
+   * @param hint id of a page the new page should be close to, INVALID_PAGE_ID for none
+   * @param strategy access strategy of the operation, if any
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  Page *NewPgNearImp(page_id_t *page_id, page_id_t hint, BufferAccessStrategy *strategy) override;
+
+  /**
+   * Hand the prefetch hint to the responsible BufferPoolManagerInstance.
+   * @param page_id id of page to be prefetched
+   * @param strategy access strategy of the operation the page is prefetched for, if any
+   */
+  void PrefetchPgImp(page_id_t page_id, BufferAccessStrategy *strategy) override;
+
+  /** The individual BufferPoolManagerInstances, instance i owns the page ids equal to i modulo their number. */
+  std::vector<BufferPoolManagerInstance *> instances_;
+  /** Indexes of all instances, in order. */
+  std::vector<size_t> all_instances_;
+  /** Turn of the next NewPgImp, rotates the preference among equally occupied instances. */
+  std::atomic<size_t> next_instance_{0};
+  /** Number of NUMA nodes the instances are spread over, 1 if the system is not NUMA. */
+  int num_nodes_;
+  /** Indexes of the instances placed on each NUMA node. */
+  std::vector<std::vector<size_t>> node_instances_;
+  /** Number of accesses to instances on a remote NUMA node. */
+  std::atomic<uint64_t> remote_accesses_{0};
 };
 }  // namespace bustub
@@ -12,10 +12,15 @@
 
 #pragma once
 
+#include <vector>
+
 #include "common/config.h"
 
 namespace bustub {
 
+/** Replacement policies a buffer pool can be constructed with. */
+enum class ReplacerType { LRU, LRU_K, CLOCK, ARC };
+
 /**
  * Replacer is an abstract class that tracks page usage.
  */
@@ -43,6 +48,29 @@ class Replacer {
    */
   virtual void Unpin(frame_id_t frame_id) = 0;
 
+  /**
+   * Tells the replacer which page a frame holds from now on. Called when a page is loaded into a frame, before the
+   * frame is pinned or unpinned for it. Replacers that remember pages after evicting them key that history by page id;
+   * the others ignore it.
+   * @param frame_id the id of the frame
+   * @param page_id the id of the page now in the frame
+   */
+  virtual void AssignPage(frame_id_t frame_id, page_id_t page_id) {}
+
+  /**
+   * Drops a frame from the replacer along with any access history kept for it, e.g. because its page was deleted.
+   * @param frame_id the id of the frame to remove
+   */
+  virtual void Remove(frame_id_t frame_id) { Pin(frame_id); }
+
+  /**
+   * Lists the frames that would be victimized next, in victim order, without removing them. Replacers that cannot
+   * predict their victims cheaply list none.
+   * @param max_frames the maximum number of frames to list
+   * @param[out] frame_ids the listed frames are appended here
+   */
+  virtual void PeekVictims(size_t max_frames, std::vector<frame_id_t> *frame_ids) {}
+
   /** @return the number of elements in the replacer that can be victimized */
   virtual size_t Size() = 0;
 };
@@ -0,0 +1,94 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// swip.h
+//
+// Identification: src/include/buffer/swip.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * Swip is a reference from one page to another, e.g. from a B+ tree internal page to a child, that can be swizzled:
+ * while the child is resident, the swip remembers the frame holding it, so fetching it again goes straight to the
+ * frame instead of through the page table lookup.
+ *
+ * A swizzled swip also remembers the generation of the frame. A page leaving its frame bumps the generation, which
+ * unswizzles every swip pointing at it; the next fetch notices, falls back to the page id and swizzles again. Swips
+ * therefore never need to be tracked down on eviction, and hold nothing that must not be written to disk: only the
+ * page id is persistent.
+ */
+class Swip {
+ public:
+  /**
+   * Creates a new unswizzled swip.
+   * @param page_id the page referenced
+   */
+  explicit Swip(page_id_t page_id = INVALID_PAGE_ID) : page_id_(page_id) {}
+
+  DISALLOW_COPY_AND_MOVE(Swip);
+
+  /** @return the page referenced */
+  inline page_id_t GetPageId() const { return page_id_; }
+
+  /**
+   * Point the swip at another page. Not thread safe, the owner of the swip has to hold off readers.
+   * @param page_id the page referenced
+   */
+  inline void SetPageId(page_id_t page_id) {
+    page_id_ = page_id;
+    Unswizzle();
+  }
+
+  /** @return true if the swip remembers a frame. The page may have left the frame since. */
+  inline bool IsSwizzled() const { return ref_.load(std::memory_order_relaxed) != UNSWIZZLED; }
+
+  /**
+   * @param[out] frame_id the frame the page was in when the swip was swizzled
+   * @param[out] generation the generation of the frame at that time
+   * @return false if the swip is not swizzled
+   */
+  inline bool GetFrame(frame_id_t *frame_id, uint32_t *generation) const {
+    const uint64_t ref = ref_.load(std::memory_order_relaxed);
+    if (ref == UNSWIZZLED) {
+      return false;
+    }
+    *frame_id = static_cast<frame_id_t>(ref >> 32);
+    *generation = static_cast<uint32_t>(ref);
+    return true;
+  }
+
+  /**
+   * Remember the frame holding the page. Only the buffer pool holding the page calls this.
+   * @param frame_id the frame holding the page
+   * @param generation the current generation of the frame
+   */
+  inline void Swizzle(frame_id_t frame_id, uint32_t generation) {
+    ref_.store(static_cast<uint64_t>(frame_id) << 32 | generation, std::memory_order_relaxed);
+  }
+
+  /** Forget the frame. */
+  inline void Unswizzle() { ref_.store(UNSWIZZLED, std::memory_order_relaxed); }
+
+ private:
+  /** Value of ref_ of an unswizzled swip, no frame has this id. */
+  static constexpr uint64_t UNSWIZZLED = ~uint64_t{0};
+
+  page_id_t page_id_;
+  /** Frame id in the high half, frame generation in the low half. */
+  std::atomic<uint64_t> ref_{UNSWIZZLED};
+};
+
+}  // namespace bustub
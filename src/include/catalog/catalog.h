@@ -13,6 +13,7 @@
 #pragma once
 
 #include <memory>
+#include <optional>
 #include <string>
 #include <unordered_map>
 #include <utility>
@@ -217,10 +218,14 @@ class Catalog {
     auto index = std::make_unique<ExtendibleHashTableIndex<KeyType, ValueType, KeyComparator>>(std::move(meta), bpm_,
                                                                                                hash_function);
 
-    // Populate the index with all tuples in table heap
+    // Populate the index with all tuples in table heap, reading a large table through a ring of its own
     auto *table_meta = GetTable(table_name);
     auto *heap = table_meta->table_.get();
-    for (auto tuple = heap->Begin(txn); tuple != heap->End(); ++tuple) {
+    std::optional<BufferAccessStrategy> strategy;
+    if (BufferAccessStrategy::IsLargeRelation(bpm_, heap->GetNumPages())) {
+      strategy.emplace(bpm_, BufferAccessStrategyType::BULK_READ);
+    }
+    for (auto tuple = heap->Begin(txn, strategy ? &*strategy : nullptr); tuple != heap->End(); ++tuple) {
       index->InsertEntry(tuple->KeyFromTuple(schema, key_schema, key_attrs), tuple->GetRid(), txn);
     }
 
@@ -23,11 +23,15 @@ namespace bustub {
 
 class BustubInstance {
  public:
-  explicit BustubInstance(const std::string &db_file_name) {
+  /**
+   * @param db_file_name the database file
+   * @param direct_io true to access the database file with O_DIRECT instead of through the OS page cache
+   */
+  explicit BustubInstance(const std::string &db_file_name, bool direct_io = false) {
     enable_logging = false;
 
     // storage related
-    disk_manager_ = new DiskManager(db_file_name);
+    disk_manager_ = new DiskManager(db_file_name, direct_io);
 
     // log related
     log_manager_ = new LogManager(disk_manager_);
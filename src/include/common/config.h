@@ -27,14 +27,61 @@ extern std::atomic<bool> enable_logging;
 /** If ENABLE_LOGGING is true, the log should be flushed to disk every LOG_TIMEOUT. */
 extern std::chrono::duration<int64_t> log_timeout;
 
+/** The log records of a transaction committing asynchronously are written out at most ASYNC_COMMIT_MAX_LAG after. */
+extern std::chrono::milliseconds async_commit_max_lag;
+
+/** An asynchronous commit waits for the log to be written if more than this many bytes of it are not durable. */
+extern std::atomic<size_t> async_commit_max_lag_bytes;
+
+/** Number of pages a table scan asks the buffer pool to prefetch ahead of the page it is reading, 0 disables it. */
+extern std::atomic<size_t> read_ahead_window;
+
+/** The background writer of every buffer pool instance wakes up every BACKGROUND_WRITER_INTERVAL. */
+extern std::chrono::milliseconds background_writer_interval;
+
+/** Number of frames at the victim end the background writer looks at per round, 0 disables it. */
+extern std::atomic<size_t> background_writer_max_pages;
+
+/** Shrinking a buffer pool gives up if pages in the frames being dropped are still pinned after this long. */
+extern std::chrono::milliseconds buffer_pool_resize_timeout;
+
+/** True if buffer pool instances should save which pages they hold and warm up from that list at startup. */
+extern std::atomic<bool> enable_buffer_pool_dump;
+
+/** If ENABLE_BUFFER_POOL_DUMP is true, every instance saves its resident pages every BUFFER_POOL_DUMP_INTERVAL. */
+extern std::chrono::milliseconds buffer_pool_dump_interval;
+
+/** True if new pages should come from buffer pool instances on the NUMA node of the calling thread first. */
+extern std::atomic<bool> enable_numa_local_allocation;
+
+/** Bytes of memory each buffer pool instance keeps clean evicted pages in, compressed. 0 disables the tier. */
+extern std::atomic<size_t> compressed_page_cache_size;
+
+/** True if asynchronous page I/O should go through io_uring, false to always use a pool of pread/pwrite workers. */
+extern std::atomic<bool> enable_io_uring;
+
+/** Number of asynchronous page I/O requests the disk manager keeps in flight at most. */
+extern std::atomic<size_t> async_io_queue_depth;
+
+/** Number of worker threads doing asynchronous page I/O when io_uring is not used. */
+extern std::atomic<size_t> async_io_worker_threads;
+
+/** True if the disk manager should checksum pages on write and verify them on read, read when it is created. */
+extern std::atomic<bool> enable_page_checksums;
+
 static constexpr int INVALID_PAGE_ID = -1;                                    // invalid page id
 static constexpr int INVALID_TXN_ID = -1;                                     // invalid transaction id
 static constexpr int INVALID_LSN = -1;                                        // invalid log sequence number
 static constexpr int HEADER_PAGE_ID = 0;                                      // the header page id
 static constexpr int PAGE_SIZE = 4096;                                        // size of a data page in byte
+static constexpr int PAGE_CHECKSUM_OFFSET = PAGE_SIZE - 4;                    // layouts end here, a checksum follows
 static constexpr int BUFFER_POOL_SIZE = 10;                                   // size of buffer pool
 static constexpr int LOG_BUFFER_SIZE = ((BUFFER_POOL_SIZE + 1) * PAGE_SIZE);  // size of a log buffer in byte
 static constexpr int BUCKET_SIZE = 50;                                        // size of extendible hash bucket
+static constexpr int LRUK_REPLACER_K = 2;                                     // lookback window for lru-k replacer
+static constexpr int BULK_READ_RING_SIZE = 16;                                // frames a bulk read ring recycles
+static constexpr int BULK_WRITE_RING_SIZE = 64;                               // frames a bulk write ring recycles
+static constexpr int BULK_RELATION_FRACTION = 4;  // relations over pool / this many pages go through a ring
 
 using frame_id_t = int32_t;    // frame id type
 using page_id_t = int32_t;     // page id type
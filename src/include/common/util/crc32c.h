@@ -0,0 +1,37 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// crc32c.h
+//
+// Identification: src/include/common/util/crc32c.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace bustub {
+
+/**
+ * Crc32c computes CRC-32C (Castagnoli) checksums. It uses the CRC32 instructions of SSE 4.2 or ARMv8 when the build
+ * targets them, and a table otherwise.
+ */
+class Crc32c {
+ public:
+  /**
+   * @param data the bytes to checksum
+   * @param size number of bytes
+   * @return the CRC-32C of the bytes
+   */
+  static uint32_t Compute(const char *data, size_t size);
+
+  /** @return true if Compute() uses CRC32 instructions */
+  static bool IsHardwareAccelerated();
+};
+
+}  // namespace bustub
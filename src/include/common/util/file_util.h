@@ -0,0 +1,34 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// file_util.h
+//
+// Identification: src/include/common/util/file_util.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <string>
+
+namespace bustub {
+
+/**
+ * FileUtil writes small files that have to survive a crash, like the metadata kept next to a database.
+ */
+class FileUtil {
+ public:
+  /**
+   * Replace the contents of a file so that after a crash it holds either the old or the new contents. The new ones go
+   * to a temporary file, which is synced and renamed over the file, and the directory is synced after the rename.
+   * @param file_name the file to replace, created if it does not exist
+   * @param data the new contents
+   * @return false on an I/O error, the file is left as it was
+   */
+  static bool ReplaceFile(const std::string &file_name, const std::string &data);
+};
+
+}  // namespace bustub
@@ -0,0 +1,53 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lz_compressor.h
+//
+// Identification: src/include/common/util/lz_compressor.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+
+namespace bustub {
+
+/**
+ * LZCompressor is a small LZ77 compressor in the spirit of LZ4: a greedy single pass with a hash table of recent
+ * 4 byte sequences, trading compression ratio for speed. It is meant for pages, inputs are limited to 64 KB.
+ *
+ * The output is a series of sequences, each a token byte holding the literal length (high nibble) and the match
+ * length minus 4 (low nibble), extra length bytes if a nibble is 15, the literals, then the 2 byte match offset and
+ * extra match length bytes. The last sequence only has literals.
+ */
+class LZCompressor {
+ public:
+  /** Largest input the compressor takes. */
+  static constexpr size_t MAX_INPUT_SIZE = 65535;
+
+  /**
+   * Compress a block of data.
+   * @param src data to compress
+   * @param size length of the data, at most MAX_INPUT_SIZE
+   * @param[out] dst buffer for the compressed data
+   * @param capacity size of dst
+   * @return the length of the compressed data, 0 if it does not fit into capacity bytes
+   */
+  static size_t Compress(const char *src, size_t size, char *dst, size_t capacity);
+
+  /**
+   * Decompress a block of data.
+   * @param src compressed data
+   * @param size length of the compressed data
+   * @param[out] dst buffer for the decompressed data
+   * @param capacity exact length of the decompressed data
+   * @return false if the compressed data is corrupt or does not decompress to capacity bytes
+   */
+  static bool Decompress(const char *src, size_t size, char *dst, size_t capacity);
+};
+
+}  // namespace bustub
@@ -0,0 +1,42 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// numa_util.h
+//
+// Identification: src/include/common/util/numa_util.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+
+namespace bustub {
+
+/**
+ * NumaUtil tells which NUMA node code runs on and places memory on a node. It talks to the kernel directly, so that
+ * BusTub does not depend on libnuma. On systems without NUMA everything is on node 0.
+ */
+class NumaUtil {
+ public:
+  /** @return the number of NUMA nodes of the system, 1 if it does not tell */
+  static int NumNodes();
+
+  /** @return the node the calling thread runs on right now, 0 if unknown */
+  static int CurrentNode();
+
+  /**
+   * Have the pages of a memory region allocated from a node when they are first touched. The node is preferred, not
+   * required: once it is out of memory, pages come from other nodes instead of failing.
+   * @param addr start of the region, aligned to the system page size
+   * @param length length of the region in bytes
+   * @param node the node to place the region on
+   * @return false if the kernel refused
+   */
+  static bool BindMemory(void *addr, size_t length, int node);
+};
+
+}  // namespace bustub
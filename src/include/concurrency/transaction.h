@@ -246,6 +246,16 @@ class Transaction {
    */
   inline void SetPrevLSN(lsn_t prev_lsn) { prev_lsn_ = prev_lsn; }
 
+  /** @return true if committing returns before the commit record is durable */
+  inline bool IsAsyncCommit() const { return async_commit_; }
+
+  /**
+   * Set whether committing waits for the commit record to be durable, losing the transaction on a crash right after
+   * is acceptable if it does not.
+   * @param async_commit true to commit asynchronously
+   */
+  inline void SetAsyncCommit(bool async_commit) { async_commit_ = async_commit; }
+
  private:
   /** The current transaction state. */
   TransactionState state_;
@@ -262,6 +272,8 @@ class Transaction {
   std::shared_ptr<std::deque<IndexWriteRecord>> index_write_set_;
   /** The LSN of the last record written by the transaction. */
   lsn_t prev_lsn_;
+  /** True if committing does not wait for the commit record to be durable. */
+  bool async_commit_{false};
 
   /** Concurrent index: the pages that were latched during index operation. */
   std::shared_ptr<std::deque<Page *>> page_set_;
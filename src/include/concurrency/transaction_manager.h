@@ -49,6 +49,12 @@ class TransactionManager {
    */
   void Commit(Transaction *txn);
 
+  /**
+   * Set whether every transaction commits asynchronously, see Transaction::SetAsyncCommit().
+   * @param async_commit true to commit asynchronously
+   */
+  void SetAsyncCommit(bool async_commit) { async_commit_ = async_commit; }
+
   /**
    * Aborts a transaction
    * @param txn the transaction to abort
@@ -103,7 +109,9 @@ class TransactionManager {
 
   std::atomic<txn_id_t> next_txn_id_{0};
   LockManager *lock_manager_ __attribute__((__unused__));
-  LogManager *log_manager_ __attribute__((__unused__));
+  LogManager *log_manager_;
+  /** True if transactions commit asynchronously, whatever their own setting. */
+  std::atomic<bool> async_commit_{false};
 
   /** The global transaction latch is used for checkpointing. */
   ReaderWriterLatch global_txn_latch_;
@@ -12,8 +12,10 @@
 
 #pragma once
 
+#include <memory>
 #include <vector>
 
+#include "buffer/buffer_access_strategy.h"
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
 #include "execution/plans/seq_scan_plan.h"
@@ -50,5 +52,11 @@ class SeqScanExecutor : public AbstractExecutor {
  private:
   /** The sequential scan plan node to be executed */
   const SeqScanPlanNode *plan_;
+  /** The table being scanned */
+  const TableInfo *table_info_{nullptr};
+  /** Ring the scan reads the table through, so that scanning a large table does not flush the buffer pool */
+  std::unique_ptr<BufferAccessStrategy> strategy_;
+  /** Position of the scan in the table heap */
+  std::unique_ptr<TableIterator> iterator_;
 };
 }  // namespace bustub
@@ -13,9 +13,13 @@
 #pragma once
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>              // NOLINT
 #include <condition_variable>  // NOLINT
-#include <future>              // NOLINT
-#include <mutex>               // NOLINT
+#include <cstdint>
+#include <future>  // NOLINT
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
 
 #include "recovery/log_record.h"
 #include "storage/disk/disk_manager.h"
@@ -25,16 +29,23 @@ namespace bustub {
 /**
  * LogManager maintains a separate thread that is awakened whenever the log buffer is full or whenever a timeout
  * happens. When the thread is awakened, the log buffer's content is written into the disk log file.
+ *
+ * Appending takes no latch: a single fetch-add on reservation_ hands an appender both its LSN and its room in the log
+ * buffer, and the record is copied in without holding anything. A flush closes the buffer to further reservations,
+ * waits for the copies into it to finish, and swaps it with the flush buffer, so appenders go on while it is written.
+ * Committing transactions wait for the persistent LSN to pass their commit record. The flush thread writes everything
+ * appended while the previous write was in progress at once, so that a single sync makes a whole group of commits
+ * durable (group commit).
  */
 class LogManager {
  public:
-  explicit LogManager(DiskManager *disk_manager)
-      : next_lsn_(0), persistent_lsn_(INVALID_LSN), disk_manager_(disk_manager) {
+  explicit LogManager(DiskManager *disk_manager) : persistent_lsn_(INVALID_LSN), disk_manager_(disk_manager) {
     log_buffer_ = new char[LOG_BUFFER_SIZE];
     flush_buffer_ = new char[LOG_BUFFER_SIZE];
   }
 
   ~LogManager() {
+    StopFlushThread();
     delete[] log_buffer_;
     delete[] flush_buffer_;
     log_buffer_ = nullptr;
@@ -46,29 +57,92 @@ class LogManager {
 
   lsn_t AppendLogRecord(LogRecord *log_record);
 
-  inline lsn_t GetNextLSN() { return next_lsn_; }
+  /**
+   * Write the log buffer to disk and sync it, making every record appended so far durable.
+   */
+  void Flush();
+
+  /**
+   * Block until the log is durable up to and including a record. The flush thread is woken up to write it, and
+   * writes the records of every transaction waiting meanwhile with it.
+   * @param lsn LSN of the record
+   */
+  void FlushTo(lsn_t lsn);
+
+  /**
+   * Have the flush thread make a record durable within async_commit_max_lag, without waiting for it. Waits like
+   * FlushTo() if more than async_commit_max_lag_bytes of the log are not durable, or if there is no flush thread.
+   * @param lsn LSN of the record
+   */
+  void FlushLazy(lsn_t lsn);
+
+  /** @return bytes of log appended but not durable yet */
+  size_t GetLagBytes() const;
+
+  inline lsn_t GetNextLSN() { return Lsn(reservation_.load()); }
   inline lsn_t GetPersistentLSN() { return persistent_lsn_; }
   inline void SetPersistentLSN(lsn_t lsn) { persistent_lsn_ = lsn; }
   inline char *GetLogBuffer() { return log_buffer_; }
 
  private:
-  // TODO(students): you may add your own member variables
-
-  /** The atomic counter which records the next log sequence number. */
-  std::atomic<lsn_t> next_lsn_;
+  /** Added to reservation_ for every record, the LSN lives in the high 32 bits. */
+  static constexpr uint64_t ONE_LSN = uint64_t{1} << 32;
+  /** Added to reservation_ to close the log buffer, no record fits after it. */
+  static constexpr uint64_t CLOSED = uint64_t{1} << 30;
+  /** Value of overflow_ while every record fits into the log buffer. */
+  static constexpr uint64_t NO_OVERFLOW = UINT64_MAX;
+
+  /** @return the LSN part of a reservation */
+  static inline lsn_t Lsn(uint64_t reservation) { return static_cast<lsn_t>(reservation >> 32); }
+  /** @return the log buffer offset part of a reservation */
+  static inline uint32_t Offset(uint64_t reservation) { return static_cast<uint32_t>(reservation); }
+
+  /**
+   * Swap the log buffer with the flush buffer once the records reserved in it are copied in, and write it to disk.
+   * Caller holds flush_latch_.
+   */
+  void FlushBuffer();
+
+  /**
+   * Serialize a log record in the format described in log_record.h.
+   * @param log_record the record, with its LSN set
+   * @param[out] data where the record goes, log_record->size_ bytes
+   */
+  static void SerializeLogRecord(const LogRecord &log_record, char *data);
+
+  /** Bytes of the flush buffer being written, 0 while none is. */
+  std::atomic<uint32_t> writing_{0};
+  /** LSN of the next record in the high 32 bits, bytes reserved in log_buffer_ in the low ones. */
+  std::atomic<uint64_t> reservation_{0};
+  /** Bytes of log_buffer_ the appenders have copied their records into. */
+  std::atomic<uint32_t> copied_{0};
+  /** Reservation of the first record that did not fit into log_buffer_, which ends where it would have started. */
+  std::atomic<uint64_t> overflow_{NO_OVERFLOW};
   /** The log records before and including the persistent lsn have been written to disk. */
   std::atomic<lsn_t> persistent_lsn_;
 
   char *log_buffer_;
   char *flush_buffer_;
 
+  /** Protects the flush requests and the flush thread. */
   std::mutex latch_;
-
-  std::thread *flush_thread_ __attribute__((__unused__));
-
+  /** Held while the buffers are swapped and written, one flush at a time. */
+  std::mutex flush_latch_;
+
+  std::thread *flush_thread_{nullptr};
+  /** True to have the flush thread write the log buffer right away. */
+  bool flush_requested_{false};
+  /** The flush thread writes the log buffer by then at the latest, an asynchronous commit waits for it. */
+  std::chrono::steady_clock::time_point flush_deadline_{std::chrono::steady_clock::time_point::max()};
+  /** True to have the flush thread exit. */
+  bool stop_flush_thread_{false};
+
+  /** Wakes the flush thread up. */
   std::condition_variable cv_;
+  /** Signalled whenever the persistent LSN moves. */
+  std::condition_variable flushed_cv_;
 
-  DiskManager *disk_manager_ __attribute__((__unused__));
+  DiskManager *disk_manager_;
 };
 
 }  // namespace bustub
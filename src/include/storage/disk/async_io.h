@@ -0,0 +1,103 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// async_io.h
+//
+// Identification: src/include/storage/disk/async_io.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <sys/types.h>
+#include <sys/uio.h>
+
+#include <algorithm>
+#include <climits>
+#include <functional>
+#include <utility>
+#include <vector>
+
+namespace bustub {
+
+/**
+ * One asynchronous read or write of a contiguous range of a file, scattered over or gathered from several buffers.
+ */
+struct AsyncIoRequest {
+  AsyncIoRequest(bool is_write, int fd, off_t offset, std::vector<iovec> iovs, std::function<void(ssize_t)> callback)
+      : is_write_(is_write), fd_(fd), offset_(offset), iovs_(std::move(iovs)), callback_(std::move(callback)) {}
+
+  /**
+   * Start the next chunk of the transfer, at most IOV_MAX buffers.
+   * @return the number of buffers, starting at iov_index_, the chunk covers
+   */
+  int NextChunk() {
+    const size_t num_iovs = std::min<size_t>(iovs_.size() - iov_index_, IOV_MAX);
+    chunk_bytes_ = 0;
+    for (size_t i = iov_index_; i < iov_index_ + num_iovs; ++i) {
+      chunk_bytes_ += iovs_[i].iov_len;
+    }
+    return static_cast<int>(num_iovs);
+  }
+
+  /**
+   * Account for bytes transferred by the current chunk, so that the rest can be issued again.
+   * @param bytes number of bytes transferred
+   * @return true if the request is finished: everything is transferred, or a read came back short because the file
+   * ends. A short read is not issued again, with O_DIRECT the rest would start at an unaligned offset.
+   */
+  bool Advance(size_t bytes) {
+    const bool short_read = !is_write_ && bytes < chunk_bytes_;
+    transferred_ += bytes;
+    offset_ += bytes;
+    for (; iov_index_ < iovs_.size() && bytes >= iovs_[iov_index_].iov_len; ++iov_index_) {
+      bytes -= iovs_[iov_index_].iov_len;
+    }
+    if (iov_index_ < iovs_.size()) {
+      iovs_[iov_index_].iov_base = static_cast<char *>(iovs_[iov_index_].iov_base) + bytes;
+      iovs_[iov_index_].iov_len -= bytes;
+    }
+    return short_read || iov_index_ == iovs_.size();
+  }
+
+  /** True to write the buffers to the file, false to read the file into them. */
+  bool is_write_;
+  /** The file. */
+  int fd_;
+  /** Offset in the file of the first byte not transferred yet. */
+  off_t offset_;
+  /** The buffers, in file order. Those before iov_index_ are transferred, the one at iov_index_ partially. */
+  std::vector<iovec> iovs_;
+  /** Called once with the number of bytes transferred, which is short only for a read hitting the end of the file,
+   * or with -errno if the request failed. */
+  std::function<void(ssize_t)> callback_;
+  /** First buffer not completely transferred yet. */
+  size_t iov_index_{0};
+  /** Bytes transferred so far. */
+  ssize_t transferred_{0};
+  /** Bytes the current chunk asks for. */
+  size_t chunk_bytes_{0};
+};
+
+/**
+ * AsyncIo keeps many reads and writes in flight at once. Requests complete in any order, their callbacks run on a
+ * thread of the backend and must not block on further I/O.
+ */
+class AsyncIo {
+ public:
+  AsyncIo() = default;
+
+  /** Waits for every submitted request to complete. */
+  virtual ~AsyncIo() = default;
+
+  /**
+   * Queue a request, waiting while the backend has as many requests in flight as it takes.
+   * @param request the read or write
+   */
+  virtual void Submit(AsyncIoRequest request) = 0;
+};
+
+}  // namespace bustub
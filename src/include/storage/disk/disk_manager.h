@@ -13,12 +13,15 @@
 #pragma once
 
 #include <atomic>
-#include <fstream>
+#include <cstdint>
 #include <future>  // NOLINT
 #include <mutex>   // NOLINT
 #include <string>
+#include <vector>
 
 #include "common/config.h"
+#include "common/macros.h"
+#include "storage/disk/async_io.h"
 
 namespace bustub {
 
@@ -31,10 +34,34 @@ class DiskManager {
   /**
    * Creates a new disk manager that writes to the specified database file.
    * @param db_file the file name of the database file to write to
+   * @param direct_io true to open the database file with O_DIRECT, bypassing the OS page cache so that pages held by
+   * the buffer pool are not cached twice. Page buffers not aligned to PAGE_SIZE are bounced through aligned copies.
+   * Falls back to buffered I/O where the file system does not support O_DIRECT.
+   *
+   * With enable_page_checksums on, every written page carries a CRC32C of its contents in its last
+   * PAGE_SIZE - PAGE_CHECKSUM_OFFSET bytes, which go out in the same write, and every page read is checked against it.
+   * A database has to be opened with the setting it was written with.
    */
-  explicit DiskManager(const std::string &db_file);
+  explicit DiskManager(const std::string &db_file, bool direct_io = false);
 
-  ~DiskManager() = default;
+  /**
+   * Creates a new disk manager that stripes the pages of the database over several data files, e.g. one per disk, so
+   * that independent devices serve misses concurrently. Stripe units of stripe_pages consecutive pages go round robin
+   * over the files. The layout is saved next to the database file, test.db keeps it in test.tsp, and a disk manager
+   * created for the database later on uses the saved layout.
+   * @param db_file the file name of the database, which names the log and layout files; the pages live in data_files
+   * and db_file only marks the database as striped
+   * @param data_files the data files, in stripe order; empty for the saved layout, or db_file alone if there is none
+   * @param stripe_pages number of consecutive pages in a stripe unit
+   * @param direct_io true to open the data files with O_DIRECT
+   * @throws Exception if the database was created with a different layout, or its layout is lost
+   */
+  DiskManager(const std::string &db_file, const std::vector<std::string> &data_files, size_t stripe_pages,
+              bool direct_io = false);
+
+  ~DiskManager();
+
+  DISALLOW_COPY_AND_MOVE(DiskManager);
 
   /**
    * Shut down the disk manager and close all the file resources.
@@ -42,21 +69,66 @@ class DiskManager {
   void ShutDown();
 
   /**
-   * Write a page to the database file.
+   * Write a page to the database file. Pages are read and written with positional I/O, so any number of threads can
+   * do page I/O at the same time. A written page reaches the OS right away, but is only durable after SyncPages().
    * @param page_id id of the page
-   * @param page_data raw page data
+   * @param page_data raw page data, its bytes from PAGE_CHECKSUM_OFFSET on are replaced by the checksum on disk
    */
   void WritePage(page_id_t page_id, const char *page_data);
 
   /**
-   * Read a page from the database file.
+   * Write several pages to the database file in one go. Each run of consecutive page ids goes out as a single
+   * vectored write, and the file is synced once at the end.
+   * @param page_ids ids of the pages, in ascending order
+   * @param page_data raw page data, one per page id
+   */
+  void WritePages(const std::vector<page_id_t> &page_ids, const char *const *page_data);
+
+  /**
+   * Read a page from the database file. The part of the page past the end of the file reads as zeroes.
    * @param page_id id of the page
    * @param[out] page_data output buffer
+   * @throws CorruptionException if the page does not match its checksum
    */
   void ReadPage(page_id_t page_id, char *page_data);
 
   /**
-   * Flush the entire log buffer into disk.
+   * Read several pages from the database file in one go. Each run of consecutive page ids comes in as a single
+   * vectored read.
+   * @param page_ids ids of the pages, in ascending order
+   * @param[out] page_data output buffers, one per page id
+   * @throws CorruptionException if a page does not match its checksum, after all pages are read
+   */
+  void ReadPages(const std::vector<page_id_t> &page_ids, char *const *page_data);
+
+  /**
+   * Start reading a page from the database file. Asynchronous I/O goes through io_uring, or through a pool of worker
+   * threads where io_uring is not available, and keeps up to async_io_queue_depth requests in flight.
+   * @param page_id id of the page
+   * @param[out] page_data output buffer, which must stay valid until the read completes
+   * @return a future that is ready once the page is in page_data, the part past the end of the file as zeroes, and
+   * holds a CorruptionException if the page does not match its checksum
+   * @throws Exception if the disk manager is shut down
+   */
+  std::future<void> ReadPageAsync(page_id_t page_id, char *page_data);
+
+  /**
+   * Start writing a page to the database file. Like WritePage(), the page is only durable after SyncPages().
+   * @param page_id id of the page
+   * @param page_data raw page data, which must stay valid and unchanged until the write completes
+   * @return a future that is ready once the page is written
+   * @throws Exception if the disk manager is shut down
+   */
+  std::future<void> WritePageAsync(page_id_t page_id, const char *page_data);
+
+  /**
+   * Make every page written so far durable. This is the sync point for page writes, WritePage() itself does not wait
+   * for the disk.
+   */
+  void SyncPages();
+
+  /**
+   * Flush the entire log buffer into disk, returning once it is synced.
    * @param log_data raw log data
    * @param size size of log entry
    */
@@ -69,7 +141,7 @@ class DiskManager {
    * @param offset offset of the log entry in the file
    * @return true if the read was successful, false otherwise
    */
-  bool ReadLog(char *log_data, int size, int offset);
+  bool ReadLog(char *log_data, int size, int64_t offset);
 
   /** @return the number of disk flushes */
   int GetNumFlushes() const;
@@ -80,6 +152,33 @@ class DiskManager {
   /** @return the number of disk writes */
   int GetNumWrites() const;
 
+  /** @return the number of disk reads */
+  int GetNumReads() const;
+
+  /** @return the number of syncs of the database file */
+  int GetNumSyncs() const;
+
+  /** @return true if the asynchronous I/O goes through io_uring, false for worker threads or before the first one */
+  bool UsesIoUring() const;
+
+  /**
+   * @param file_name name of a file
+   * @return the size of the file in bytes, -1 if it can't be read
+   */
+  int64_t GetFileSize(const std::string &file_name);
+
+  /** @return the number of page ids the data files have room for, 0 for a new database */
+  size_t GetNumPages() const;
+
+  /** @return the number of data files the pages are striped over */
+  inline size_t GetNumDataFiles() const { return data_fds_.size(); }
+
+  /** @return true if the database file is accessed with O_DIRECT */
+  inline bool IsDirectIo() const { return direct_io_; }
+
+  /** @return the name of the database file */
+  inline const std::string &GetFileName() const { return file_name_; }
+
   /**
    * Sets the future which is used to check for non-blocking flushes.
    * @param f the non-blocking flush check
@@ -90,19 +189,83 @@ class DiskManager {
   inline bool HasFlushLogFuture() { return flush_log_f_ != nullptr; }
 
  private:
-  int GetFileSize(const std::string &file_name);
-  // stream to write log file
-  std::fstream log_io_;
+  /**
+   * Submit a read or write of consecutive pages to the asynchronous backend, creating the backend on first use.
+   * @param is_write true to write the pages, false to read them
+   * @param page_data buffers of the pages
+   * @param num_pages number of pages
+   * @param page_id id of the first page
+   * @return a future that is ready once all pages are transferred
+   * @throws Exception if the disk manager is shut down, the backend is not created again
+   */
+  std::future<void> SubmitRun(bool is_write, char *const *page_data, size_t num_pages, page_id_t page_id);
+
+  /**
+   * Find where a page lives.
+   * @param page_id id of the page
+   * @param[out] offset offset of the page in its data file
+   * @return the descriptor of the data file
+   */
+  int Locate(page_id_t page_id, off_t *offset) const;
+
+  /** @return true if page_id directly follows prev_page_id in the same data file */
+  bool IsContiguous(page_id_t prev_page_id, page_id_t page_id) const;
+
+  /** Close the data files that are open. */
+  void CloseDataFiles();
+
+  /** @return true if a page buffer has to be bounced through an aligned copy for O_DIRECT */
+  inline bool NeedsBounce(const char *page_data) const {
+    return direct_io_ && reinterpret_cast<uintptr_t>(page_data) % PAGE_SIZE != 0;
+  }
+
+  /** @return an aligned page to bounce a page through, one given back earlier if there is one */
+  char *TakeBouncePage();
+
+  /**
+   * Give a bounce page back once its I/O is done, to be used again.
+   * @param page the page
+   */
+  void GiveBackBouncePage(char *page);
+
+  /**
+   * Store the checksum of a page about to be written into the page itself, if checksums are on.
+   * @param page_data the disk manager's own copy of the page
+   */
+  void StampChecksum(char *page_data) const;
+
+  /**
+   * Check a page that was read against the checksum stored in it. A page of zeroes was never written and passes.
+   * @throws CorruptionException if the page does not match
+   */
+  void VerifyChecksum(page_id_t page_id, const char *page_data) const;
+
+  // descriptor of the log file
+  int log_fd_{-1};
   std::string log_name_;
-  // stream to write db file
-  std::fstream db_io_;
+  // descriptors of the data files, pread/pwrite carry their own offset so concurrent page I/O needs no latch
+  std::vector<int> data_fds_;
+  std::vector<std::string> data_files_;
+  // number of consecutive pages in a stripe unit
+  size_t stripe_pages_;
+  bool direct_io_;
+  bool page_checksums_;
   std::string file_name_;
   int num_flushes_;
-  int num_writes_;
+  std::atomic<int> num_writes_;
+  std::atomic<int> num_reads_;
+  std::atomic<int> num_syncs_;
   bool flush_log_;
   std::future<void> *flush_log_f_;
-  // With multiple buffer pool instances, need to protect file access
-  std::mutex db_io_latch_;
+  // backend of the asynchronous page I/O, created by the first request
+  AsyncIo *async_io_{nullptr};
+  std::once_flag async_io_created_;
+  bool uses_io_uring_{false};
+  /** Most bounce pages kept around for later I/O, 8 MB worth. */
+  static constexpr size_t MAX_FREE_BOUNCE_PAGES = 2048;
+  // bounce pages given back, allocating and faulting in fresh ones would cost more than the I/O they serve
+  std::vector<char *> free_bounce_pages_;
+  std::mutex bounce_latch_;
 };
 
 }  // namespace bustub
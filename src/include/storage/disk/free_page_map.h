@@ -0,0 +1,132 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// free_page_map.h
+//
+// Identification: src/include/storage/disk/free_page_map.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <mutex>  // NOLINT
+#include <string>
+#include <vector>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * FreePageMap keeps track of which page ids of one buffer pool instance are free, so that deleted pages are handed out
+ * again instead of growing the database file forever. An instance owns the page ids that mod back to its index; the
+ * map numbers them densely (page id = index * num_instances + instance_index) and keeps one bit per id, set if free.
+ *
+ * The map is saved in its own file next to the database file. A free id is written back as taken and synced before it
+ * is handed out, and ids past the end of the map are reserved in synced chunks, so a crash can leak ids but never hand
+ * one out twice. Reusing an id therefore costs a sync of the map file.
+ *
+ * File layout:
+ * ---------------------------------------------------------------------
+ * | Magic (4) | NumInstances (4) | EndIndex (8) | Bitmap words (8 each) |
+ * ---------------------------------------------------------------------
+ */
+class FreePageMap {
+ public:
+  /**
+   * Open the map of an instance, or start a new one.
+   * @param file_name file the map is kept in
+   * @param num_instances total number of instances page ids are spread over
+   * @param instance_index index of the instance the map is for
+   * @param db_num_pages number of pages in the database file, 0 for a new database
+   */
+  FreePageMap(const std::string &file_name, uint32_t num_instances, uint32_t instance_index, size_t db_num_pages);
+
+  /**
+   * Save the map and close its file.
+   */
+  ~FreePageMap();
+
+  DISALLOW_COPY_AND_MOVE(FreePageMap);
+
+  /**
+   * Take a page id. Without a hint the lowest free id is reused; with one, the free id closest to the hint is, unless
+   * growing the file lands closer.
+   * @param hint id of a page the new page should be close to, INVALID_PAGE_ID for none
+   * @return the allocated page id
+   */
+  page_id_t Allocate(page_id_t hint = INVALID_PAGE_ID);
+
+  /**
+   * Give a page id back. Ids that were never handed out or are already free are ignored.
+   * @param page_id id of the page to free
+   */
+  void Deallocate(page_id_t page_id);
+
+  /**
+   * Write the exact end of the map and sync the file, so that a clean restart does not lose reserved ids.
+   */
+  void Sync();
+
+  /** @return the number of free page ids below the end of the map */
+  size_t GetNumFree();
+
+ private:
+  /** Marks a free page map file. */
+  static constexpr uint32_t MAGIC = 0x4d505346;
+  /** Size of the header in front of the bitmap. */
+  static constexpr size_t HEADER_SIZE = 16;
+  /** Number of ids reserved past the end of the map at once when it grows. */
+  static constexpr size_t RESERVE_CHUNK = 64;
+  /** Bits per bitmap word. */
+  static constexpr size_t WORD_BITS = 64;
+
+  inline page_id_t ToPageId(size_t index) const {
+    return static_cast<page_id_t>(index * num_instances_ + instance_index_);
+  }
+  inline size_t ToIndex(page_id_t page_id) const { return static_cast<size_t>(page_id) / num_instances_; }
+  inline bool IsFree(size_t index) const { return (words_[index / WORD_BITS] >> (index % WORD_BITS) & 1) != 0; }
+
+  /**
+   * Find the free index closest to target.
+   * @param target index to search around
+   * @param[out] index the free index found
+   * @return false if no index is free
+   */
+  bool FindFreeNear(size_t target, size_t *index) const;
+
+  /**
+   * Load the map from its file.
+   * @return false if there is no valid map in the file
+   */
+  bool Load();
+
+  /** Write the header with the given end index. */
+  void WriteHeader(uint64_t end_index);
+  /** Write one word of the bitmap. */
+  void WriteWord(size_t word);
+  /** Make what was written so far durable. */
+  void SyncFile();
+
+  std::string file_name_;
+  /** Descriptor of the map file, -1 if it can't be opened. */
+  int fd_{-1};
+  const uint32_t num_instances_;
+  const uint32_t instance_index_;
+  /** One bit per index below end_index_, set if the page id is free. */
+  std::vector<uint64_t> words_;
+  /** Indexes at or past it were never handed out. */
+  size_t end_index_{0};
+  /** End index saved in the file, at least end_index_. */
+  size_t reserved_index_{0};
+  /** Number of set bits in words_. */
+  size_t num_free_{0};
+  std::mutex latch_;
+};
+
+}  // namespace bustub
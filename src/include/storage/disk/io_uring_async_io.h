@@ -0,0 +1,98 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// io_uring_async_io.h
+//
+// Identification: src/include/storage/disk/io_uring_async_io.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <linux/io_uring.h>
+
+#include <condition_variable>  // NOLINT
+#include <mutex>               // NOLINT
+#include <thread>              // NOLINT
+#include <unordered_set>
+
+#include "common/macros.h"
+#include "storage/disk/async_io.h"
+
+namespace bustub {
+
+/**
+ * IoUringAsyncIo hands requests to the kernel through an io_uring submission queue and reaps them on a completion
+ * thread, so that a single thread keeps the whole queue depth in flight. The ring is driven with the raw system calls.
+ * Partial transfers are issued again for the rest from the completion thread. Should the ring itself fail, the
+ * requests in flight and every later one fail with the error.
+ */
+class IoUringAsyncIo : public AsyncIo {
+ public:
+  /**
+   * Creates a new IoUringAsyncIo.
+   * @param queue_depth number of requests in flight at most
+   * @throws Exception if the kernel does not provide io_uring
+   */
+  explicit IoUringAsyncIo(size_t queue_depth);
+
+  ~IoUringAsyncIo() override;
+
+  DISALLOW_COPY_AND_MOVE(IoUringAsyncIo);
+
+  void Submit(AsyncIoRequest request) override;
+
+ private:
+  /**
+   * Put a request into the submission queue and tell the kernel about it. Caller holds sq_latch_.
+   * @param request the request, or nullptr for a no-op that wakes the completion thread up
+   * @return 0, or -errno if the kernel did not take the request, which is then out of the queue again
+   */
+  int PushSubmission(AsyncIoRequest *request);
+
+  /** Body of the completion thread, reaps completions until a no-op arrives or the ring fails. */
+  void CompletionLoop();
+
+  /**
+   * Fail every request in flight, and every later one, once the completion thread cannot reap them any more.
+   * @param error -errno of the failure
+   */
+  void FailAll(int error);
+
+  int ring_fd_{-1};
+  /** Number of entries of the submission queue, the most requests in flight at once. */
+  unsigned sq_entries_{0};
+
+  // The rings shared with the kernel.
+  void *sq_ring_{nullptr};
+  size_t sq_ring_size_{0};
+  void *cq_ring_{nullptr};
+  size_t cq_ring_size_{0};
+  io_uring_sqe *sqes_{nullptr};
+  size_t sqes_size_{0};
+  unsigned *sq_head_{nullptr};
+  unsigned *sq_tail_{nullptr};
+  unsigned *sq_mask_{nullptr};
+  unsigned *sq_array_{nullptr};
+  unsigned *cq_head_{nullptr};
+  unsigned *cq_tail_{nullptr};
+  unsigned *cq_mask_{nullptr};
+  io_uring_cqe *cqes_{nullptr};
+
+  /** Number of submitted requests not completed yet. */
+  size_t in_flight_{0};
+  /** The submitted requests not completed yet. */
+  std::unordered_set<AsyncIoRequest *> requests_;
+  /** -errno once the ring failed, 0 before. */
+  int error_{0};
+  /** Protects the submission queue, in_flight_, requests_ and error_. */
+  std::mutex sq_latch_;
+  /** Signalled whenever a request completes. */
+  std::condition_variable completed_cv_;
+  std::thread *completion_thread_{nullptr};
+};
+
+}  // namespace bustub
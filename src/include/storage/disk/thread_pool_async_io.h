@@ -0,0 +1,63 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// thread_pool_async_io.h
+//
+// Identification: src/include/storage/disk/thread_pool_async_io.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "common/macros.h"
+#include "storage/disk/async_io.h"
+
+namespace bustub {
+
+/**
+ * ThreadPoolAsyncIo serves requests with a pool of worker threads doing blocking preadv/pwritev, one request per
+ * worker at a time. It is the fallback where io_uring is not available.
+ */
+class ThreadPoolAsyncIo : public AsyncIo {
+ public:
+  /**
+   * Creates a new ThreadPoolAsyncIo.
+   * @param num_workers number of worker threads, the number of requests in flight
+   * @param queue_depth number of requests waiting for a worker at most
+   */
+  ThreadPoolAsyncIo(size_t num_workers, size_t queue_depth);
+
+  ~ThreadPoolAsyncIo() override;
+
+  DISALLOW_COPY_AND_MOVE(ThreadPoolAsyncIo);
+
+  void Submit(AsyncIoRequest request) override;
+
+ private:
+  /** Body of the worker threads, serves queued requests until the pool is destroyed. */
+  void WorkerLoop();
+
+  const size_t queue_depth_;
+  /** Requests waiting for a worker, oldest first. */
+  std::deque<AsyncIoRequest> queue_;
+  /** Tells the workers to exit once the queue is empty. */
+  bool stop_{false};
+  /** Protects queue_ and stop_. */
+  std::mutex latch_;
+  /** Wakes a worker up when a request is queued or the pool shuts down. */
+  std::condition_variable queued_cv_;
+  /** Wakes submitters up when the queue has room again. */
+  std::condition_variable room_cv_;
+  std::vector<std::thread> workers_;
+};
+
+}  // namespace bustub
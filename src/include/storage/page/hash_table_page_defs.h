@@ -24,9 +24,9 @@
  * approximate calculation based on the size of MappingType (which is a std::pair of KeyType and ValueType). For each
  * key/value pair, we need two additional bits for occupied_ and readable_. 4 * PAGE_SIZE / (4 * sizeof (MappingType) +
  * 1) = PAGE_SIZE/(sizeof (MappingType) + 0.25) because 0.25 bytes = 2 bits is the space required to maintain the
- * occupied and readable flags for a key value pair.
+ * occupied and readable flags for a key value pair. The page ends at PAGE_CHECKSUM_OFFSET, the rest holds its checksum.
  */
-#define BLOCK_ARRAY_SIZE (4 * PAGE_SIZE / (4 * sizeof(MappingType) + 1))
+#define BLOCK_ARRAY_SIZE (4 * PAGE_CHECKSUM_OFFSET / (4 * sizeof(MappingType) + 1))
 
 /**
  * Extendible Hashing Definitions
@@ -39,6 +39,7 @@
  * It is an approximate calculation based on the size of MappingType (which is a std::pair of KeyType and ValueType).
  * For each key/value pair, we need two additional bits for occupied_ and readable_. 4 * (PAGE_SIZE - 4) / (4 * sizeof
  * (MappingType) + 1) = (PAGE_SIZE - 4)/(sizeof (MappingType) + 0.25) because 0.25 bytes = 2 bits is the space required
- * to maintain the occupied and readable flags for a key value pair.
+ * to maintain the occupied and readable flags for a key value pair. The page ends at PAGE_CHECKSUM_OFFSET, the rest
+ * holds its checksum.
  */
-#define BUCKET_ARRAY_SIZE (4 * PAGE_SIZE / (4 * sizeof(MappingType) + 1))
+#define BUCKET_ARRAY_SIZE (4 * PAGE_CHECKSUM_OFFSET / (4 * sizeof(MappingType) + 1))
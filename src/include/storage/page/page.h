@@ -12,8 +12,10 @@
 
 #pragma once
 
+#include <atomic>
 #include <cstring>
 #include <iostream>
+#include <new>
 
 #include "common/config.h"
 #include "common/rwlatch.h"
@@ -24,17 +26,27 @@ namespace bustub {
  * Page is the basic unit of storage within the database system. Page provides a wrapper for actual data pages being
  * held in main memory. Page also contains book-keeping information that is used by the buffer pool manager, e.g.
  * pin count, dirty flag, page id, etc.
+ *
+ * The book-keeping information is kept apart from the data and padded to whole cache lines, so that the buffer pool
+ * can go through the frames without dragging page data into the cache or sharing lines between frames.
  */
-class Page {
+class alignas(64) Page {
   // There is book-keeping information inside the page that should only be relevant to the buffer pool manager.
   friend class BufferPoolManagerInstance;
 
  public:
-  /** Constructor. Zeros out the page data. */
-  Page() { ResetMemory(); }
-
-  /** Default destructor. */
-  ~Page() = default;
+  /** Constructor for a page that lives outside of a buffer pool. Allocates and zeros out the page data. */
+  Page() : Page(new (std::align_val_t(PAGE_SIZE)) char[PAGE_SIZE]) {
+    owns_data_ = true;
+    ResetMemory();
+  }
+
+  /** Destructor. Frees the page data unless it belongs to a buffer pool. */
+  ~Page() {
+    if (owns_data_) {
+      operator delete[](data_, std::align_val_t(PAGE_SIZE));
+    }
+  }
 
   /** @return the actual data contained within this page */
   inline char *GetData() { return data_; }
@@ -75,17 +87,30 @@ class Page {
   static constexpr size_t OFFSET_LSN = 4;
 
  private:
+  /**
+   * Constructor for a frame of a buffer pool.
+   * @param data the PAGE_SIZE bytes of the frame, owned by the buffer pool
+   */
+  explicit Page(char *data) : data_(data) {}
+
   /** Zeroes out the data that is held within the page. */
   inline void ResetMemory() { memset(data_, OFFSET_PAGE_START, PAGE_SIZE); }
 
-  /** The actual data that is stored within a page. */
-  char data_[PAGE_SIZE]{};
+  /** The actual data that is stored within a page, PAGE_SIZE aligned. */
+  char *data_;
   /** The ID of this page. */
   page_id_t page_id_ = INVALID_PAGE_ID;
-  /** The pin count of this page. */
-  int pin_count_ = 0;
+  /** The pin count of this page. Atomic so that buffer pool hits can pin without the buffer pool latch. */
+  std::atomic<int> pin_count_ = 0;
   /** True if the page is dirty, i.e. it is different from its corresponding page on disk. */
-  bool is_dirty_ = false;
+  std::atomic<bool> is_dirty_ = false;
+  /**
+   * Bumped whenever a page leaves the frame, which invalidates every swip still pointing at the frame. Changed under
+   * the page table stripe latch of the page that leaves.
+   */
+  std::atomic<uint32_t> generation_ = 0;
+  /** True if data_ was allocated by the page itself. */
+  bool owns_data_ = false;
   /** Page latch. */
   ReaderWriterLatch rwlatch_;
 };
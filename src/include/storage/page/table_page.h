@@ -46,7 +46,7 @@ class TablePage : public Page {
   /**
    * Initialize the TablePage header.
    * @param page_id the page ID of this table page
-   * @param page_size the size of this table page
+   * @param page_size the size of this table page, PAGE_CHECKSUM_OFFSET for a page of a table heap
    * @param prev_page_id the previous table page ID
    * @param log_manager the log manager in use
    * @param txn the transaction that this page is created in
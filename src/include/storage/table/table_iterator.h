@@ -20,6 +20,7 @@
 
 namespace bustub {
 
+class BufferAccessStrategy;
 class TableHeap;
 
 /**
@@ -29,10 +30,21 @@ class TableIterator {
   friend class Cursor;
 
  public:
-  TableIterator(TableHeap *table_heap, RID rid, Transaction *txn);
+  /**
+   * @param table_heap the table being scanned
+   * @param rid the first tuple of the scan
+   * @param txn the transaction performing the scan
+   * @param strategy access strategy the scan reads pages with, nullptr to read through the shared pool
+   */
+  TableIterator(TableHeap *table_heap, RID rid, Transaction *txn, BufferAccessStrategy *strategy = nullptr);
 
   TableIterator(const TableIterator &other)
-      : table_heap_(other.table_heap_), tuple_(new Tuple(*other.tuple_)), txn_(other.txn_) {}
+      : table_heap_(other.table_heap_),
+        tuple_(new Tuple(*other.tuple_)),
+        txn_(other.txn_),
+        strategy_(other.strategy_),
+        read_ahead_tail_(other.read_ahead_tail_),
+        read_ahead_pages_(other.read_ahead_pages_) {}
 
   ~TableIterator() { delete tuple_; }
 
@@ -52,13 +64,35 @@ class TableIterator {
     table_heap_ = other.table_heap_;
     *tuple_ = *other.tuple_;
     txn_ = other.txn_;
+    strategy_ = other.strategy_;
+    read_ahead_tail_ = other.read_ahead_tail_;
+    read_ahead_pages_ = other.read_ahead_pages_;
     return *this;
   }
 
  private:
+  /**
+   * Keep up to read_ahead_window pages following the current page in flight. The next page id is stored in the
+   * previous page, so the window only grows through pages that are already resident, which are peeked at without
+   * pinning them for the replacer. The scan never blocks on a page it is not reading yet.
+   */
+  void ReadAhead();
+
+  /**
+   * Account for the scan having moved on to the given page.
+   * @param page_id id of the page the scan now reads
+   */
+  void AdvanceReadAhead(page_id_t page_id);
+
   TableHeap *table_heap_;
   Tuple *tuple_;
   Transaction *txn_;
+  /** Access strategy of the scan, owned by whoever started it. */
+  BufferAccessStrategy *strategy_;
+  /** Last page handed to the buffer pool as a prefetch hint, or the current page if there is none. */
+  page_id_t read_ahead_tail_{INVALID_PAGE_ID};
+  /** Number of pages between the current page (exclusive) and read_ahead_tail_ (inclusive). */
+  size_t read_ahead_pages_{0};
 };
 
 }  // namespace bustub
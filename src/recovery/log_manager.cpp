@@ -12,6 +12,9 @@
 
 #include "recovery/log_manager.h"
 
+#include <cassert>
+#include <cstring>
+
 namespace bustub {
 /*
  * set enable_logging = true
@@ -22,33 +25,211 @@ namespace bustub {
  *
  * This thread runs forever until system shutdown/StopFlushThread
  */
-void LogManager::RunFlushThread() {}
+void LogManager::RunFlushThread() {
+  std::scoped_lock lock(latch_);
+  if (flush_thread_ != nullptr) {
+    return;
+  }
+  enable_logging = true;
+  stop_flush_thread_ = false;
+  flush_thread_ = new std::thread([this] {
+    std::unique_lock lock(latch_);
+    while (!stop_flush_thread_) {
+      // Asynchronous commits may move the deadline up while the thread waits.
+      const auto timeout = std::chrono::steady_clock::now() + log_timeout;
+      while (!flush_requested_ && !stop_flush_thread_) {
+        const auto deadline = std::min(timeout, flush_deadline_);
+        if (std::chrono::steady_clock::now() >= deadline) {
+          break;
+        }
+        cv_.wait_until(lock, deadline);
+      }
+      // Whatever gets appended from now on waits for the next round, and is written with everything else that
+      // arrives while this one is on its way to disk.
+      flush_requested_ = false;
+      flush_deadline_ = std::chrono::steady_clock::time_point::max();
+      lock.unlock();
+      Flush();
+      lock.lock();
+    }
+  });
+}
 
 /*
  * Stop and join the flush thread, set enable_logging = false
  */
-void LogManager::StopFlushThread() {}
+void LogManager::StopFlushThread() {
+  std::thread *flush_thread;
+  {
+    std::scoped_lock lock(latch_);
+    flush_thread = flush_thread_;
+    stop_flush_thread_ = true;
+  }
+  if (flush_thread == nullptr) {
+    return;
+  }
+  cv_.notify_one();
+  flush_thread->join();
+  delete flush_thread;
+  {
+    std::scoped_lock lock(latch_);
+    flush_thread_ = nullptr;
+  }
+  Flush();
+  enable_logging = false;
+}
 
 /*
  * append a log record into log buffer
  * you MUST set the log record's lsn within this method
  * @return: lsn that is assigned to this log record
- *
- *
- * example below
- * // First, serialize the must have fields(20 bytes in total)
- * log_record.lsn_ = next_lsn_++;
- * memcpy(log_buffer_ + offset_, &log_record, 20);
- * int pos = offset_ + 20;
- *
- * if (log_record.log_record_type_ == LogRecordType::INSERT) {
- *    memcpy(log_buffer_ + pos, &log_record.insert_rid_, sizeof(RID));
- *    pos += sizeof(RID);
- *    // we have provided serialize function for tuple class
- *    log_record.insert_tuple_.SerializeTo(log_buffer_ + pos);
- *  }
- *
  */
-lsn_t LogManager::AppendLogRecord(LogRecord *log_record) { return INVALID_LSN; }
+lsn_t LogManager::AppendLogRecord(LogRecord *log_record) {
+  const auto size = static_cast<uint32_t>(log_record->size_);
+  assert(size <= static_cast<uint32_t>(LOG_BUFFER_SIZE));
+  while (true) {
+    const uint64_t reservation = reservation_.fetch_add(ONE_LSN + size, std::memory_order_acquire);
+    const uint32_t offset = Offset(reservation);
+    if (offset + size <= LOG_BUFFER_SIZE) {
+      // The buffer cannot be swapped before copied_ accounts for this record.
+      log_record->lsn_ = Lsn(reservation);
+      SerializeLogRecord(*log_record, log_buffer_ + offset);
+      copied_.fetch_add(size, std::memory_order_release);
+      return log_record->lsn_;
+    }
+    if (offset <= LOG_BUFFER_SIZE) {
+      // The first record that does not fit ends the buffer. Those after it start past the end.
+      overflow_.store(reservation, std::memory_order_release);
+    }
+    // Flush the full buffer unless someone did meanwhile, then try again in the empty one.
+    std::scoped_lock flush_lock(flush_latch_);
+    if (Offset(reservation_.load()) > LOG_BUFFER_SIZE) {
+      FlushBuffer();
+    }
+  }
+}
+
+void LogManager::Flush() {
+  std::scoped_lock flush_lock(flush_latch_);
+  FlushBuffer();
+}
+
+void LogManager::FlushBuffer() {
+  // Close the buffer, every reservation from now on fails.
+  uint64_t end = reservation_.fetch_add(CLOSED, std::memory_order_acquire);
+  if (Offset(end) > LOG_BUFFER_SIZE) {
+    // the buffer is full, the record that did not fit tells where it ends
+    while ((end = overflow_.load(std::memory_order_acquire)) == NO_OVERFLOW) {
+      std::this_thread::yield();
+    }
+  }
+  const uint32_t size = Offset(end);
+  if (size == 0) {
+    // nothing to write, reopen the buffer as it is
+    reservation_.store(end, std::memory_order_release);
+    return;
+  }
+  // Wait for the appenders still copying their records in.
+  while (copied_.load(std::memory_order_acquire) != size) {
+    std::this_thread::yield();
+  }
+  // Hand the buffer to the disk and reopen the other one. Reservations that failed while the buffer was closed take
+  // their LSNs again once they retry, so LSNs stay dense.
+  std::swap(log_buffer_, flush_buffer_);
+  writing_ = size;
+  copied_.store(0, std::memory_order_relaxed);
+  overflow_.store(NO_OVERFLOW, std::memory_order_relaxed);
+  reservation_.store(static_cast<uint64_t>(Lsn(end)) << 32, std::memory_order_release);
+
+  disk_manager_->WriteLog(flush_buffer_, static_cast<int>(size));
+  {
+    std::scoped_lock lock(latch_);
+    persistent_lsn_ = Lsn(end) - 1;
+  }
+  writing_ = 0;
+  flushed_cv_.notify_all();
+}
+
+void LogManager::FlushTo(lsn_t lsn) {
+  if (persistent_lsn_ >= lsn) {
+    return;
+  }
+  std::unique_lock lock(latch_);
+  while (persistent_lsn_ < lsn) {
+    if (flush_thread_ == nullptr) {
+      lock.unlock();
+      Flush();
+      lock.lock();
+      continue;
+    }
+    flush_requested_ = true;
+    cv_.notify_one();
+    flushed_cv_.wait(lock);
+  }
+}
+
+void LogManager::FlushLazy(lsn_t lsn) {
+  if (persistent_lsn_ >= lsn) {
+    return;
+  }
+  if (GetLagBytes() > async_commit_max_lag_bytes) {
+    FlushTo(lsn);
+    return;
+  }
+  std::unique_lock lock(latch_);
+  if (flush_thread_ == nullptr) {
+    // nobody would write the record
+    lock.unlock();
+    FlushTo(lsn);
+    return;
+  }
+  const auto deadline = std::chrono::steady_clock::now() + async_commit_max_lag;
+  if (deadline < flush_deadline_) {
+    flush_deadline_ = deadline;
+    cv_.notify_one();
+  }
+}
+
+size_t LogManager::GetLagBytes() const {
+  // the offset goes past the end of the buffer while it is full or closed
+  return writing_ + std::min<size_t>(Offset(reservation_.load()), LOG_BUFFER_SIZE);
+}
+
+void LogManager::SerializeLogRecord(const LogRecord &log_record, char *data) {
+  // First, serialize the must have fields (20 bytes in total).
+  memcpy(data, &log_record.size_, sizeof(int32_t));
+  memcpy(data + 4, &log_record.lsn_, sizeof(lsn_t));
+  memcpy(data + 8, &log_record.txn_id_, sizeof(txn_id_t));
+  memcpy(data + 12, &log_record.prev_lsn_, sizeof(lsn_t));
+  memcpy(data + 16, &log_record.log_record_type_, sizeof(LogRecordType));
+  char *pos = data + LogRecord::HEADER_SIZE;
+
+  switch (log_record.log_record_type_) {
+    case LogRecordType::INSERT:
+      memcpy(pos, &log_record.insert_rid_, sizeof(RID));
+      log_record.insert_tuple_.SerializeTo(pos + sizeof(RID));
+      break;
+    case LogRecordType::MARKDELETE:
+    case LogRecordType::APPLYDELETE:
+    case LogRecordType::ROLLBACKDELETE:
+      memcpy(pos, &log_record.delete_rid_, sizeof(RID));
+      log_record.delete_tuple_.SerializeTo(pos + sizeof(RID));
+      break;
+    case LogRecordType::UPDATE:
+      memcpy(pos, &log_record.update_rid_, sizeof(RID));
+      pos += sizeof(RID);
+      log_record.old_tuple_.SerializeTo(pos);
+      pos += sizeof(int32_t) + log_record.old_tuple_.GetLength();
+      log_record.new_tuple_.SerializeTo(pos);
+      break;
+    case LogRecordType::NEWPAGE:
+      memcpy(pos, &log_record.prev_page_id_, sizeof(page_id_t));
+      memcpy(pos + sizeof(page_id_t), &log_record.page_id_, sizeof(page_id_t));
+      break;
+    default:
+      // BEGIN, COMMIT and ABORT are the header alone
+      break;
+  }
+}
 
 }  // namespace bustub
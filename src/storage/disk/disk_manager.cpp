@@ -10,28 +10,175 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <fcntl.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
 #include <cassert>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
 #include <cstring>
+#include <fstream>
 #include <iostream>
-#include <mutex>  // NOLINT
+#include <memory>
 #include <string>
 #include <thread>  // NOLINT
+#include <vector>
 
 #include "common/exception.h"
 #include "common/logger.h"
+#include "common/util/crc32c.h"
+#include "common/util/file_util.h"
 #include "storage/disk/disk_manager.h"
+#include "storage/disk/io_uring_async_io.h"
+#include "storage/disk/thread_pool_async_io.h"
 
 namespace bustub {
 
 static char *buffer_used;
 
+// page offsets are computed as off_t, a database file past 2 GB needs it 64-bit wide
+static_assert(sizeof(off_t) >= sizeof(int64_t), "off_t must be 64-bit, build with _FILE_OFFSET_BITS=64");
+
+/**
+ * Write a page at offset, retrying partial writes
+ */
+static void WriteFully(int fd, const char *page_data, off_t offset) {
+  size_t written = 0;
+  while (written < PAGE_SIZE) {
+    ssize_t result = pwrite(fd, page_data + written, PAGE_SIZE - written, offset + written);
+    if (result < 0 && errno == EINTR) {
+      continue;
+    }
+    if (result <= 0) {
+      LOG_DEBUG("I/O error while writing");
+      return;
+    }
+    written += result;
+  }
+}
+
+/**
+ * Read a page at offset. Whatever lies past the end of the file is zero-filled.
+ */
+static void ReadFully(int fd, char *page_data, off_t offset) {
+  ssize_t result;
+  do {
+    result = pread(fd, page_data, PAGE_SIZE, offset);
+  } while (result < 0 && errno == EINTR);
+  if (result < 0) {
+    LOG_DEBUG("I/O error while reading");
+    return;
+  }
+  // A read of a regular file only comes back short where the file ends. It is not retried for the rest, with O_DIRECT
+  // that would be an unaligned read.
+  if (result < PAGE_SIZE) {
+    LOG_DEBUG("Read less than a page");
+    memset(page_data + result, 0, PAGE_SIZE - result);
+  }
+}
+
+
+/** Marks a tablespace layout file. */
+static constexpr uint32_t LAYOUT_MAGIC = 0x42545350;
+
+/**
+ * Read a saved tablespace layout
+ * @return false if there is none
+ * @throws Exception if the layout file is there but can't be read
+ */
+static bool ReadLayout(const std::string &file_name, uint32_t *stripe_pages, std::vector<std::string> *data_files) {
+  std::ifstream in(file_name, std::ios::binary);
+  if (!in.is_open()) {
+    return false;
+  }
+  uint32_t magic = 0;
+  uint32_t num_files = 0;
+  in.read(reinterpret_cast<char *>(&magic), sizeof(magic));
+  in.read(reinterpret_cast<char *>(stripe_pages), sizeof(*stripe_pages));
+  in.read(reinterpret_cast<char *>(&num_files), sizeof(num_files));
+  if (!in || magic != LAYOUT_MAGIC || *stripe_pages == 0 || num_files == 0) {
+    throw Exception("can't read tablespace layout");
+  }
+  data_files->resize(num_files);
+  for (auto &data_file : *data_files) {
+    uint32_t length = 0;
+    in.read(reinterpret_cast<char *>(&length), sizeof(length));
+    data_file.resize(length);
+    in.read(data_file.data(), length);
+  }
+  if (!in) {
+    throw Exception("can't read tablespace layout");
+  }
+  return true;
+}
+
+/**
+ * Save a tablespace layout durably, replacing the file only once the new one is complete
+ */
+static void WriteLayout(const std::string &file_name, uint32_t stripe_pages,
+                        const std::vector<std::string> &data_files) {
+  std::string data;
+  const auto num_files = static_cast<uint32_t>(data_files.size());
+  data.append(reinterpret_cast<const char *>(&LAYOUT_MAGIC), sizeof(LAYOUT_MAGIC));
+  data.append(reinterpret_cast<const char *>(&stripe_pages), sizeof(stripe_pages));
+  data.append(reinterpret_cast<const char *>(&num_files), sizeof(num_files));
+  for (const auto &data_file : data_files) {
+    const auto length = static_cast<uint32_t>(data_file.size());
+    data.append(reinterpret_cast<const char *>(&length), sizeof(length));
+    data.append(data_file);
+  }
+  if (!FileUtil::ReplaceFile(file_name, data)) {
+    throw Exception("can't save tablespace layout");
+  }
+}
+
+/** @return true if the file exists and is not empty */
+static bool HasData(const std::string &file_name) {
+  struct stat stat_buf;
+  return stat(file_name.c_str(), &stat_buf) == 0 && stat_buf.st_size > 0;
+}
+
+/**
+ * A striped database leaves LAYOUT_MAGIC alone in db_file, which it keeps no pages in, so that an open finds out the
+ * database is striped even when the layout file is gone. A file of pages is never that short.
+ * @return true if the file marks a striped database
+ */
+static bool IsStripedMarker(const std::string &file_name) {
+  std::ifstream in(file_name, std::ios::binary | std::ios::ate);
+  if (!in.is_open() || in.tellg() != static_cast<std::streamoff>(sizeof(LAYOUT_MAGIC))) {
+    return false;
+  }
+  uint32_t magic = 0;
+  in.seekg(0);
+  in.read(reinterpret_cast<char *>(&magic), sizeof(magic));
+  return in && magic == LAYOUT_MAGIC;
+}
+
 /**
  * Constructor: open/create a single database file & log file
  * @input db_file: database file name
  */
-DiskManager::DiskManager(const std::string &db_file)
-    : file_name_(db_file), num_flushes_(0), num_writes_(0), flush_log_(false), flush_log_f_(nullptr) {
+DiskManager::DiskManager(const std::string &db_file, bool direct_io) : DiskManager(db_file, {}, 1, direct_io) {}
+
+/**
+ * Constructor: open/create the data files of a database striped over several files & log file
+ */
+DiskManager::DiskManager(const std::string &db_file, const std::vector<std::string> &data_files, size_t stripe_pages,
+                         bool direct_io)
+    : stripe_pages_(1),
+      direct_io_(direct_io),
+      page_checksums_(enable_page_checksums),
+      file_name_(db_file),
+      num_flushes_(0),
+      num_writes_(0),
+      num_reads_(0),
+      num_syncs_(0),
+      flush_log_(false),
+      flush_log_f_(nullptr) {
   std::string::size_type n = file_name_.rfind('.');
   if (n == std::string::npos) {
     LOG_DEBUG("wrong file format");
@@ -39,94 +186,348 @@ DiskManager::DiskManager(const std::string &db_file)
   }
   log_name_ = file_name_.substr(0, n) + ".log";
 
-  log_io_.open(log_name_, std::ios::binary | std::ios::in | std::ios::app | std::ios::out);
-  // directory or file does not exist
-  if (!log_io_.is_open()) {
-    log_io_.clear();
-    // create a new file
-    log_io_.open(log_name_, std::ios::binary | std::ios::trunc | std::ios::app | std::ios::out);
-    log_io_.close();
-    // reopen with original mode
-    log_io_.open(log_name_, std::ios::binary | std::ios::in | std::ios::app | std::ios::out);
-    if (!log_io_.is_open()) {
-      throw Exception("can't open dblog file");
-    }
-  }
-
-  std::scoped_lock scoped_db_io_latch(db_io_latch_);
-  db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
-  // directory or file does not exist
-  if (!db_io_.is_open()) {
-    db_io_.clear();
-    // create a new file
-    db_io_.open(db_file, std::ios::binary | std::ios::trunc | std::ios::out);
-    db_io_.close();
-    // reopen with original mode
-    db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
-    if (!db_io_.is_open()) {
+  // the log is only ever appended to, and read back by offset during recovery
+  log_fd_ = open(log_name_.c_str(), O_RDWR | O_CREAT | O_APPEND, 0666);
+  if (log_fd_ < 0) {
+    throw Exception("can't open dblog file");
+  }
+
+  // A striped database keeps its layout next to it, test.db in test.tsp, so that a restart finds its data files.
+  const std::string layout_file_name = file_name_.substr(0, n) + ".tsp";
+  uint32_t saved_stripe_pages;
+  std::vector<std::string> saved_data_files;
+  if (ReadLayout(layout_file_name, &saved_stripe_pages, &saved_data_files)) {
+    if (!data_files.empty() && (data_files != saved_data_files || stripe_pages != saved_stripe_pages)) {
+      throw Exception("db file has a different tablespace layout");
+    }
+    data_files_ = std::move(saved_data_files);
+    stripe_pages_ = saved_stripe_pages;
+  } else if (!data_files.empty()) {
+    // Without the layout the stripe unit the pages were written with is unknown, guessing it would scramble them.
+    if (std::any_of(data_files.begin(), data_files.end(), HasData)) {
+      throw Exception("the tablespace layout of the data files is missing");
+    }
+    data_files_ = data_files;
+    stripe_pages_ = std::max<size_t>(stripe_pages, 1);
+    WriteLayout(layout_file_name, stripe_pages_, data_files_);
+    // Only mark db_file once the layout is saved, a crash in between must not leave a marker without a layout.
+    const std::string marker(reinterpret_cast<const char *>(&LAYOUT_MAGIC), sizeof(LAYOUT_MAGIC));
+    if (std::find(data_files_.begin(), data_files_.end(), db_file) == data_files_.end() &&
+        !FileUtil::ReplaceFile(db_file, marker)) {
+      throw Exception("can't save tablespace layout");
+    }
+  } else {
+    if (IsStripedMarker(db_file)) {
+      throw Exception("the tablespace layout of the database is missing");
+    }
+    data_files_ = {db_file};
+  }
+
+  // create the files if they do not exist
+  while (data_fds_.size() < data_files_.size()) {
+    const std::string &data_file = data_files_[data_fds_.size()];
+    int fd = open(data_file.c_str(), O_RDWR | O_CREAT | (direct_io_ ? O_DIRECT : 0), 0666);
+    if (fd < 0 && direct_io_ && errno == EINVAL) {
+      // the file system does not support O_DIRECT, open all files again without it
+      LOG_DEBUG("O_DIRECT is not supported for %s, using buffered I/O", data_file.c_str());
+      direct_io_ = false;
+      CloseDataFiles();
+      continue;
+    }
+    if (fd < 0) {
+      CloseDataFiles();
       throw Exception("can't open db file");
     }
+    data_fds_.push_back(fd);
   }
   buffer_used = nullptr;
 }
 
+DiskManager::~DiskManager() {
+  delete async_io_;
+  for (char *page : free_bounce_pages_) {
+    std::free(page);
+  }
+  CloseDataFiles();
+  if (log_fd_ >= 0) {
+    close(log_fd_);
+  }
+}
+
+void DiskManager::CloseDataFiles() {
+  for (int fd : data_fds_) {
+    close(fd);
+  }
+  data_fds_.clear();
+}
+
+int DiskManager::Locate(page_id_t page_id, off_t *offset) const {
+  // Stripe units go round robin over the files, a file holds every num_files-th unit back to back.
+  const size_t num_files = data_fds_.size();
+  const size_t stripe = static_cast<size_t>(page_id) / stripe_pages_;
+  *offset = static_cast<off_t>((stripe / num_files) * stripe_pages_ + page_id % stripe_pages_) * PAGE_SIZE;
+  return data_fds_[stripe % num_files];
+}
+
+bool DiskManager::IsContiguous(page_id_t prev_page_id, page_id_t page_id) const {
+  return page_id == prev_page_id + 1 && (data_fds_.size() == 1 || page_id % stripe_pages_ != 0);
+}
+
 /**
- * Close all file streams
+ * Sync the db file and close all file resources
  */
 void DiskManager::ShutDown() {
-  {
-    std::scoped_lock scoped_db_io_latch(db_io_latch_);
-    db_io_.close();
+  // wait for the asynchronous I/O still in flight
+  delete async_io_;
+  async_io_ = nullptr;
+  if (!data_fds_.empty()) {
+    SyncPages();
+    CloseDataFiles();
+  }
+  if (log_fd_ >= 0) {
+    close(log_fd_);
+    log_fd_ = -1;
   }
-  log_io_.close();
 }
 
 /**
  * Write the contents of the specified page into disk file
  */
 void DiskManager::WritePage(page_id_t page_id, const char *page_data) {
-  std::scoped_lock scoped_db_io_latch(db_io_latch_);
-  size_t offset = static_cast<size_t>(page_id) * PAGE_SIZE;
-  // set write cursor to offset
   num_writes_ += 1;
-  db_io_.seekp(offset);
-  db_io_.write(page_data, PAGE_SIZE);
-  // check for I/O error
-  if (db_io_.bad()) {
-    LOG_DEBUG("I/O error while writing");
+  off_t offset;
+  const int fd = Locate(page_id, &offset);
+  if (page_checksums_ || NeedsBounce(page_data)) {
+    // The checksum goes into a copy, it has to match the bytes written even if the page changes meanwhile.
+    char *bounce = TakeBouncePage();
+    memcpy(bounce, page_data, PAGE_SIZE);
+    StampChecksum(bounce);
+    WriteFully(fd, bounce, offset);
+    GiveBackBouncePage(bounce);
+  } else {
+    WriteFully(fd, page_data, offset);
+  }
+}
+
+/**
+ * Write the contents of the specified pages into disk file, with every run of pages contiguous in a file in flight at
+ * once and one sync at the end
+ */
+void DiskManager::WritePages(const std::vector<page_id_t> &page_ids, const char *const *page_data) {
+  if (page_ids.empty()) {
     return;
   }
-  // needs to flush to keep disk file in sync
-  db_io_.flush();
+  num_writes_ += page_ids.size();
+  std::vector<std::future<void>> writes;
+  size_t run_start = 0;
+  for (size_t i = 1; i <= page_ids.size(); ++i) {
+    if (i == page_ids.size() || !IsContiguous(page_ids[i - 1], page_ids[i])) {
+      writes.push_back(
+          SubmitRun(true, const_cast<char *const *>(page_data + run_start), i - run_start, page_ids[run_start]));
+      run_start = i;
+    }
+  }
+  for (auto &write : writes) {
+    write.wait();
+  }
+  // a single sync for the whole batch makes it durable
+  SyncPages();
 }
 
 /**
  * Read the contents of the specified page into the given memory area
  */
 void DiskManager::ReadPage(page_id_t page_id, char *page_data) {
-  std::scoped_lock scoped_db_io_latch(db_io_latch_);
-  int offset = page_id * PAGE_SIZE;
-  // check if read beyond file length
-  if (offset > GetFileSize(file_name_)) {
-    LOG_DEBUG("I/O error reading past end of file");
-    // std::cerr << "I/O error while reading" << std::endl;
+  num_reads_ += 1;
+  off_t offset;
+  const int fd = Locate(page_id, &offset);
+  if (NeedsBounce(page_data)) {
+    char *bounce = TakeBouncePage();
+    ReadFully(fd, bounce, offset);
+    memcpy(page_data, bounce, PAGE_SIZE);
+    GiveBackBouncePage(bounce);
   } else {
-    // set read cursor to offset
-    db_io_.seekp(offset);
-    db_io_.read(page_data, PAGE_SIZE);
-    if (db_io_.bad()) {
-      LOG_DEBUG("I/O error while reading");
-      return;
+    ReadFully(fd, page_data, offset);
+  }
+  VerifyChecksum(page_id, page_data);
+}
+
+/**
+ * Read the contents of the specified pages into the given memory areas, with every run of pages contiguous in a file in
+ * flight at once
+ */
+void DiskManager::ReadPages(const std::vector<page_id_t> &page_ids, char *const *page_data) {
+  if (page_ids.empty()) {
+    return;
+  }
+  num_reads_ += page_ids.size();
+  std::vector<std::future<void>> reads;
+  size_t run_start = 0;
+  for (size_t i = 1; i <= page_ids.size(); ++i) {
+    if (i == page_ids.size() || !IsContiguous(page_ids[i - 1], page_ids[i])) {
+      reads.push_back(SubmitRun(false, page_data + run_start, i - run_start, page_ids[run_start]));
+      run_start = i;
+    }
+  }
+  for (auto &read : reads) {
+    read.wait();
+  }
+  // all reads are done before a corrupt page is reported, none writes into the buffers afterwards
+  for (auto &read : reads) {
+    read.get();
+  }
+}
+
+/**
+ * Start reading the specified page into the given memory area
+ */
+std::future<void> DiskManager::ReadPageAsync(page_id_t page_id, char *page_data) {
+  num_reads_ += 1;
+  return SubmitRun(false, &page_data, 1, page_id);
+}
+
+/**
+ * Start writing the contents of the specified page into disk file
+ */
+std::future<void> DiskManager::WritePageAsync(page_id_t page_id, const char *page_data) {
+  num_writes_ += 1;
+  char *data = const_cast<char *>(page_data);
+  return SubmitRun(true, &data, 1, page_id);
+}
+
+std::future<void> DiskManager::SubmitRun(bool is_write, char *const *page_data, size_t num_pages, page_id_t page_id) {
+  std::call_once(async_io_created_, [&] {
+    if (enable_io_uring) {
+      try {
+        async_io_ = new IoUringAsyncIo(async_io_queue_depth);
+        uses_io_uring_ = true;
+        return;
+      } catch (const Exception &) {
+        LOG_DEBUG("io_uring is not available, falling back to worker threads");
+      }
+    }
+    async_io_ = new ThreadPoolAsyncIo(std::max<size_t>(async_io_worker_threads, 1), async_io_queue_depth);
+  });
+  if (async_io_ == nullptr) {
+    // ShutDown() deleted the backend and closed the files
+    throw Exception("the disk manager is shut down");
+  }
+
+  // Pages not aligned for O_DIRECT go through aligned bounce pages, which the callback copies read pages out of.
+  // Written pages get their checksum in a bounce page as well, the buffers of a write are only ever read.
+  std::vector<char *> bounces(num_pages, nullptr);
+  std::vector<iovec> iovs(num_pages);
+  for (size_t i = 0; i < num_pages; ++i) {
+    iovs[i].iov_base = page_data[i];
+    iovs[i].iov_len = PAGE_SIZE;
+    if ((is_write && page_checksums_) || NeedsBounce(page_data[i])) {
+      bounces[i] = TakeBouncePage();
+      if (is_write) {
+        memcpy(bounces[i], page_data[i], PAGE_SIZE);
+        StampChecksum(bounces[i]);
+      }
+      iovs[i].iov_base = bounces[i];
     }
-    // if file ends before reading PAGE_SIZE
-    int read_count = db_io_.gcount();
-    if (read_count < PAGE_SIZE) {
+  }
+  auto done = std::make_shared<std::promise<void>>();
+  std::future<void> future = done->get_future();
+  auto callback = [this, is_write, page_id, done, bounces = std::move(bounces),
+                   pages = std::vector<char *>(page_data, page_data + num_pages)](ssize_t result) {
+    for (size_t i = 0; i < pages.size(); ++i) {
+      if (bounces[i] != nullptr) {
+        if (!is_write) {
+          memcpy(pages[i], bounces[i], PAGE_SIZE);
+        }
+        GiveBackBouncePage(bounces[i]);
+      }
+    }
+    if (result < 0) {
+      LOG_DEBUG(is_write ? "I/O error while writing" : "I/O error while reading");
+    } else if (!is_write && static_cast<size_t>(result) < pages.size() * PAGE_SIZE) {
+      // the file ends before the run does
       LOG_DEBUG("Read less than a page");
-      db_io_.clear();
-      // std::cerr << "Read less than a page" << std::endl;
-      memset(page_data + read_count, 0, PAGE_SIZE - read_count);
+      for (size_t i = result / PAGE_SIZE; i < pages.size(); ++i) {
+        const size_t page_read = std::max<ssize_t>(result - static_cast<ssize_t>(i) * PAGE_SIZE, 0);
+        memset(pages[i] + page_read, 0, PAGE_SIZE - page_read);
+      }
+    }
+    try {
+      for (size_t i = 0; i < pages.size() && !is_write; ++i) {
+        VerifyChecksum(page_id + static_cast<page_id_t>(i), pages[i]);
+      }
+    } catch (const CorruptionException &) {
+      done->set_exception(std::current_exception());
+      return;
+    }
+    done->set_value();
+  };
+  off_t offset;
+  const int fd = Locate(page_id, &offset);
+  async_io_->Submit(AsyncIoRequest(is_write, fd, offset, std::move(iovs), std::move(callback)));
+  return future;
+}
+
+/**
+ * Flush the pages written so far from the OS to the disks
+ */
+void DiskManager::SyncPages() {
+  num_syncs_ += 1;
+  for (int fd : data_fds_) {
+    if (fdatasync(fd) != 0) {
+      LOG_DEBUG("I/O error while syncing");
+    }
+  }
+}
+
+char *DiskManager::TakeBouncePage() {
+  {
+    std::scoped_lock lock(bounce_latch_);
+    if (!free_bounce_pages_.empty()) {
+      char *page = free_bounce_pages_.back();
+      free_bounce_pages_.pop_back();
+      return page;
     }
   }
+  return static_cast<char *>(std::aligned_alloc(PAGE_SIZE, PAGE_SIZE));
+}
+
+void DiskManager::GiveBackBouncePage(char *page) {
+  {
+    std::scoped_lock lock(bounce_latch_);
+    if (free_bounce_pages_.size() < MAX_FREE_BOUNCE_PAGES) {
+      free_bounce_pages_.push_back(page);
+      return;
+    }
+  }
+  std::free(page);
+}
+
+void DiskManager::StampChecksum(char *page_data) const {
+  if (!page_checksums_) {
+    return;
+  }
+  const uint32_t checksum = Crc32c::Compute(page_data, PAGE_CHECKSUM_OFFSET);
+  memcpy(page_data + PAGE_CHECKSUM_OFFSET, &checksum, sizeof(checksum));
+}
+
+void DiskManager::VerifyChecksum(page_id_t page_id, const char *page_data) const {
+  if (!page_checksums_) {
+    return;
+  }
+  uint32_t expected;
+  memcpy(&expected, page_data + PAGE_CHECKSUM_OFFSET, sizeof(expected));
+  // The checksum of zeroes is not zero, so a stored zero only passes for a page that was never written: a hole in
+  // the file or a page past its end. A written page whose checksum happens to be zero is still checked.
+  if (expected == 0 && std::all_of(page_data, page_data + PAGE_SIZE, [](char c) { return c == 0; })) {
+    return;
+  }
+  const uint32_t actual = Crc32c::Compute(page_data, PAGE_CHECKSUM_OFFSET);
+  if (actual != expected) {
+    char message[128];
+    snprintf(message, sizeof(message), "page %d is corrupt, its checksum is %08x instead of %08x", page_id, actual,
+             expected);
+    throw CorruptionException(message);
+  }
 }
 
 /**
@@ -150,16 +551,23 @@ void DiskManager::WriteLog(char *log_data, int size) {
   }
 
   num_flushes_ += 1;
-  // sequence write
-  log_io_.write(log_data, size);
-
-  // check for I/O error
-  if (log_io_.bad()) {
-    LOG_DEBUG("I/O error while writing log");
+  // sequence write, the file is opened for appending
+  for (int written = 0; written < size;) {
+    ssize_t result = write(log_fd_, log_data + written, size - written);
+    if (result < 0 && errno == EINTR) {
+      continue;
+    }
+    if (result <= 0) {
+      LOG_DEBUG("I/O error while writing log");
+      return;
+    }
+    written += result;
+  }
+  // the log records are only durable once they are synced
+  if (fdatasync(log_fd_) != 0) {
+    LOG_DEBUG("I/O error while syncing log");
     return;
   }
-  // needs to flush to keep disk file in sync
-  log_io_.flush();
   flush_log_ = false;
 }
 
@@ -168,23 +576,29 @@ void DiskManager::WriteLog(char *log_data, int size) {
  * Always read from the beginning and perform sequence read
  * @return: false means already reach the end
  */
-bool DiskManager::ReadLog(char *log_data, int size, int offset) {
+bool DiskManager::ReadLog(char *log_data, int size, int64_t offset) {
   if (offset >= GetFileSize(log_name_)) {
     // LOG_DEBUG("end of log file");
     // LOG_DEBUG("file size is %d", GetFileSize(log_name_));
     return false;
   }
-  log_io_.seekp(offset);
-  log_io_.read(log_data, size);
-
-  if (log_io_.bad()) {
-    LOG_DEBUG("I/O error while reading log");
-    return false;
+  int read_count = 0;
+  while (read_count < size) {
+    ssize_t result = pread(log_fd_, log_data + read_count, size - read_count, offset + read_count);
+    if (result < 0 && errno == EINTR) {
+      continue;
+    }
+    if (result < 0) {
+      LOG_DEBUG("I/O error while reading log");
+      return false;
+    }
+    if (result == 0) {
+      break;
+    }
+    read_count += result;
   }
   // if log file ends before reading "size"
-  int read_count = log_io_.gcount();
   if (read_count < size) {
-    log_io_.clear();
     memset(log_data + read_count, 0, size - read_count);
   }
 
@@ -201,18 +615,49 @@ int DiskManager::GetNumFlushes() const { return num_flushes_; }
  */
 int DiskManager::GetNumWrites() const { return num_writes_; }
 
+/**
+ * Returns number of Reads made so far
+ */
+int DiskManager::GetNumReads() const { return num_reads_; }
+
+/**
+ * Returns number of syncs of the db file made so far
+ */
+int DiskManager::GetNumSyncs() const { return num_syncs_; }
+
+bool DiskManager::UsesIoUring() const { return uses_io_uring_; }
+
 /**
  * Returns true if the log is currently being flushed
  */
 bool DiskManager::GetFlushState() const { return flush_log_; }
 
+/**
+ * Returns the number of page ids the data files have room for, counting the holes of sparse files
+ */
+size_t DiskManager::GetNumPages() const {
+  const size_t num_files = data_fds_.size();
+  size_t num_pages = 0;
+  for (size_t i = 0; i < num_files; ++i) {
+    struct stat stat_buf;
+    if (fstat(data_fds_[i], &stat_buf) != 0 || stat_buf.st_size == 0) {
+      continue;
+    }
+    // map the last page slot of the file back to its page id
+    const size_t last = (stat_buf.st_size - 1) / PAGE_SIZE;
+    const size_t page_id = ((last / stripe_pages_) * num_files + i) * stripe_pages_ + last % stripe_pages_;
+    num_pages = std::max(num_pages, page_id + 1);
+  }
+  return num_pages;
+}
+
 /**
  * Private helper function to get disk file size
  */
-int DiskManager::GetFileSize(const std::string &file_name) {
+int64_t DiskManager::GetFileSize(const std::string &file_name) {
   struct stat stat_buf;
   int rc = stat(file_name.c_str(), &stat_buf);
-  return rc == 0 ? static_cast<int>(stat_buf.st_size) : -1;
+  return rc == 0 ? static_cast<int64_t>(stat_buf.st_size) : -1;
 }
 
 }  // namespace bustub
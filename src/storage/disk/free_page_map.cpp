@@ -0,0 +1,220 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// free_page_map.cpp
+//
+// Identification: src/storage/disk/free_page_map.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/free_page_map.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include "common/logger.h"
+
+namespace bustub {
+
+FreePageMap::FreePageMap(const std::string &file_name, uint32_t num_instances, uint32_t instance_index,
+                         size_t db_num_pages)
+    : file_name_(file_name), num_instances_(num_instances), instance_index_(instance_index) {
+  // Every page the database file holds may be in use, the map never ends before them.
+  size_t db_end_index = 0;
+  if (db_num_pages > instance_index_) {
+    db_end_index = (db_num_pages - instance_index_ + num_instances_ - 1) / num_instances_;
+  }
+  fd_ = open(file_name_.c_str(), O_RDWR);
+  if (db_num_pages > 0 && fd_ >= 0 && Load()) {
+    if (end_index_ < db_end_index) {
+      end_index_ = db_end_index;
+      words_.resize((end_index_ + WORD_BITS - 1) / WORD_BITS, 0);
+    }
+    return;
+  }
+  // A new database, or the map is gone.
+  end_index_ = db_end_index;
+  reserved_index_ = end_index_;
+  words_.assign((end_index_ + WORD_BITS - 1) / WORD_BITS, 0);
+  if (fd_ >= 0) {
+    close(fd_);
+  }
+  fd_ = open(file_name_.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0666);
+  if (fd_ < 0) {
+    LOG_DEBUG("can't open free page map file %s", file_name_.c_str());
+    return;
+  }
+  WriteHeader(end_index_);
+  SyncFile();
+}
+
+FreePageMap::~FreePageMap() {
+  Sync();
+  if (fd_ >= 0) {
+    close(fd_);
+  }
+}
+
+page_id_t FreePageMap::Allocate(page_id_t hint) {
+  std::scoped_lock lock(latch_);
+  size_t index;
+  bool reuse;
+  if (hint == INVALID_PAGE_ID) {
+    reuse = FindFreeNear(0, &index);
+  } else {
+    // Ids of other instances are spread the same way, so the index still tells where in the file the hint is.
+    const size_t target = ToIndex(hint);
+    reuse = FindFreeNear(target, &index);
+    if (reuse) {
+      const size_t free_distance = index > target ? index - target : target - index;
+      const size_t end_distance = end_index_ > target ? end_index_ - target : target - end_index_;
+      reuse = free_distance <= end_distance;
+    }
+  }
+
+  if (reuse) {
+    words_[index / WORD_BITS] &= ~(uint64_t{1} << (index % WORD_BITS));
+    --num_free_;
+    // The id has to be taken on disk before anybody can write the page, or a restart would hand it out again.
+    WriteWord(index / WORD_BITS);
+    SyncFile();
+    return ToPageId(index);
+  }
+
+  index = end_index_++;
+  if (words_.size() * WORD_BITS < end_index_) {
+    words_.push_back(0);
+  }
+  if (end_index_ > reserved_index_) {
+    reserved_index_ = end_index_ + RESERVE_CHUNK - 1;
+    WriteHeader(reserved_index_);
+    SyncFile();
+  }
+  return ToPageId(index);
+}
+
+void FreePageMap::Deallocate(page_id_t page_id) {
+  if (page_id < 0 || static_cast<uint32_t>(page_id) % num_instances_ != instance_index_) {
+    return;
+  }
+  const size_t index = ToIndex(page_id);
+  std::scoped_lock lock(latch_);
+  if (index >= end_index_ || IsFree(index)) {
+    return;
+  }
+  words_[index / WORD_BITS] |= uint64_t{1} << (index % WORD_BITS);
+  ++num_free_;
+  // Losing a free bit in a crash only leaks the page, so it is not flushed right away.
+  WriteWord(index / WORD_BITS);
+}
+
+void FreePageMap::Sync() {
+  std::scoped_lock lock(latch_);
+  reserved_index_ = end_index_;
+  WriteHeader(end_index_);
+  SyncFile();
+}
+
+size_t FreePageMap::GetNumFree() {
+  std::scoped_lock lock(latch_);
+  return num_free_;
+}
+
+bool FreePageMap::FindFreeNear(size_t target, size_t *index) const {
+  if (num_free_ == 0) {
+    return false;
+  }
+  const size_t num_words = words_.size();
+  const size_t target_word = std::min(target / WORD_BITS, num_words - 1);
+  bool found = false;
+  size_t best_distance = 0;
+  auto scan_word = [&](size_t word) {
+    for (uint64_t bits = words_[word]; bits != 0; bits &= bits - 1) {
+      const size_t candidate = word * WORD_BITS + __builtin_ctzll(bits);
+      const size_t distance = candidate > target ? candidate - target : target - candidate;
+      if (!found || distance < best_distance) {
+        found = true;
+        best_distance = distance;
+        *index = candidate;
+      }
+    }
+  };
+  // Walk outwards a word at a time. A bit two words further out is always farther than one in the words scanned so
+  // far, so one more round after the first hit settles it.
+  for (size_t d = 0, last = num_words; d <= last; ++d) {
+    const bool above = target_word + d < num_words;
+    const bool below = d > 0 && d <= target_word;
+    if (!above && !below) {
+      break;
+    }
+    if (above) {
+      scan_word(target_word + d);
+    }
+    if (below) {
+      scan_word(target_word - d);
+    }
+    if (found && last == num_words) {
+      last = d + 1;
+    }
+  }
+  return found;
+}
+
+bool FreePageMap::Load() {
+  char header[HEADER_SIZE];
+  if (pread(fd_, header, HEADER_SIZE, 0) != static_cast<ssize_t>(HEADER_SIZE)) {
+    return false;
+  }
+  uint32_t magic;
+  uint32_t num_instances;
+  uint64_t end_index;
+  memcpy(&magic, header, sizeof(magic));
+  memcpy(&num_instances, header + 4, sizeof(num_instances));
+  memcpy(&end_index, header + 8, sizeof(end_index));
+  if (magic != MAGIC || num_instances != num_instances_) {
+    return false;
+  }
+  end_index_ = end_index;
+  reserved_index_ = end_index_;
+  words_.assign((end_index_ + WORD_BITS - 1) / WORD_BITS, 0);
+  // Words never written are all taken, a short read leaves them zero.
+  if (pread(fd_, words_.data(), words_.size() * sizeof(uint64_t), HEADER_SIZE) < 0) {
+    LOG_DEBUG("I/O error while reading free page map");
+  }
+  num_free_ = 0;
+  for (auto word : words_) {
+    num_free_ += __builtin_popcountll(word);
+  }
+  return true;
+}
+
+void FreePageMap::WriteHeader(uint64_t end_index) {
+  char header[HEADER_SIZE];
+  memcpy(header, &MAGIC, sizeof(MAGIC));
+  memcpy(header + 4, &num_instances_, sizeof(num_instances_));
+  memcpy(header + 8, &end_index, sizeof(end_index));
+  if (fd_ >= 0 && pwrite(fd_, header, HEADER_SIZE, 0) != static_cast<ssize_t>(HEADER_SIZE)) {
+    LOG_DEBUG("I/O error while writing free page map");
+  }
+}
+
+void FreePageMap::WriteWord(size_t word) {
+  if (fd_ >= 0 && pwrite(fd_, &words_[word], sizeof(uint64_t), HEADER_SIZE + word * sizeof(uint64_t)) !=
+                      static_cast<ssize_t>(sizeof(uint64_t))) {
+    LOG_DEBUG("I/O error while writing free page map");
+  }
+}
+
+void FreePageMap::SyncFile() {
+  if (fd_ >= 0 && fdatasync(fd_) != 0) {
+    LOG_DEBUG("I/O error while syncing free page map");
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,228 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// io_uring_async_io.cpp
+//
+// Identification: src/storage/disk/io_uring_async_io.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/io_uring_async_io.h"
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include "common/exception.h"
+#include "common/logger.h"
+
+namespace bustub {
+
+static int IoUringSetup(unsigned entries, io_uring_params *params) {
+  return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+static int IoUringEnter(int ring_fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+  return static_cast<int>(syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+/** Errors io_uring_enter returns when it is worth trying again. */
+static bool IsTransient(int error) { return error == EINTR || error == EAGAIN || error == EBUSY; }
+
+IoUringAsyncIo::IoUringAsyncIo(size_t queue_depth) {
+  io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  ring_fd_ = IoUringSetup(static_cast<unsigned>(std::max<size_t>(queue_depth, 1)), &params);
+  if (ring_fd_ < 0) {
+    throw Exception("io_uring is not available");
+  }
+  sq_entries_ = params.sq_entries;
+
+  // Map the submission ring, the completion ring and the submission entries.
+  sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+  sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+  sq_ring_ = mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_,
+                  IORING_OFF_SQ_RING);
+  cq_ring_ = mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_,
+                  IORING_OFF_CQ_RING);
+  void *sqes = mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQES);
+  if (sq_ring_ == MAP_FAILED || cq_ring_ == MAP_FAILED || sqes == MAP_FAILED) {
+    for (auto [ring, size] : {std::pair{sq_ring_, sq_ring_size_}, {cq_ring_, cq_ring_size_}, {sqes, sqes_size_}}) {
+      if (ring != MAP_FAILED) {
+        munmap(ring, size);
+      }
+    }
+    close(ring_fd_);
+    throw Exception("can't map io_uring");
+  }
+  sqes_ = static_cast<io_uring_sqe *>(sqes);
+  auto *sq = static_cast<char *>(sq_ring_);
+  sq_head_ = reinterpret_cast<unsigned *>(sq + params.sq_off.head);
+  sq_tail_ = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+  sq_mask_ = reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+  sq_array_ = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+  auto *cq = static_cast<char *>(cq_ring_);
+  cq_head_ = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+  cq_tail_ = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+  cq_mask_ = reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+  cqes_ = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+
+  completion_thread_ = new std::thread(&IoUringAsyncIo::CompletionLoop, this);
+}
+
+IoUringAsyncIo::~IoUringAsyncIo() {
+  {
+    std::unique_lock lock(sq_latch_);
+    completed_cv_.wait(lock, [&] { return in_flight_ == 0; });
+    // The no-op tells the completion thread to exit. A ring that fails the no-op fails the thread's wait as well, the
+    // thread exits either way.
+    if (error_ == 0) {
+      PushSubmission(nullptr);
+    }
+  }
+  completion_thread_->join();
+  delete completion_thread_;
+  munmap(sqes_, sqes_size_);
+  munmap(cq_ring_, cq_ring_size_);
+  munmap(sq_ring_, sq_ring_size_);
+  close(ring_fd_);
+}
+
+void IoUringAsyncIo::Submit(AsyncIoRequest request) {
+  auto *pending = new AsyncIoRequest(std::move(request));
+  int error;
+  {
+    std::unique_lock lock(sq_latch_);
+    // Completions never outnumber submissions, so with at most sq_entries_ in flight the completion ring cannot
+    // overflow.
+    completed_cv_.wait(lock, [&] { return in_flight_ < sq_entries_; });
+    error = error_ != 0 ? error_ : PushSubmission(pending);
+    if (error == 0) {
+      ++in_flight_;
+      requests_.insert(pending);
+    }
+  }
+  if (error != 0) {
+    pending->callback_(error);
+    delete pending;
+  }
+}
+
+int IoUringAsyncIo::PushSubmission(AsyncIoRequest *request) {
+  // Only this thread writes the tail, the kernel consumed every earlier entry when it was submitted.
+  const unsigned tail = *sq_tail_;
+  const unsigned index = tail & *sq_mask_;
+  io_uring_sqe *sqe = &sqes_[index];
+  memset(sqe, 0, sizeof(*sqe));
+  if (request == nullptr) {
+    sqe->opcode = IORING_OP_NOP;
+  } else {
+    sqe->opcode = request->is_write_ ? IORING_OP_WRITEV : IORING_OP_READV;
+    sqe->fd = request->fd_;
+    sqe->off = request->offset_;
+    sqe->addr = reinterpret_cast<uint64_t>(request->iovs_.data() + request->iov_index_);
+    sqe->len = request->NextChunk();
+  }
+  sqe->user_data = reinterpret_cast<uint64_t>(request);
+  sq_array_[index] = index;
+  __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+  int result;
+  while ((result = IoUringEnter(ring_fd_, 1, 0, 0)) < 0 && IsTransient(errno)) {
+  }
+  if (result < 0) {
+    const int error = errno;
+    if (__atomic_load_n(sq_head_, __ATOMIC_ACQUIRE) != tail) {
+      // the kernel took the entry after all, its completion tells how it went
+      return 0;
+    }
+    // take the entry back, or the next submission would issue it
+    __atomic_store_n(sq_tail_, tail, __ATOMIC_RELEASE);
+    return -error;
+  }
+  return 0;
+}
+
+void IoUringAsyncIo::FailAll(int error) {
+  std::vector<AsyncIoRequest *> failed;
+  {
+    std::scoped_lock lock(sq_latch_);
+    error_ = error;
+    failed.assign(requests_.begin(), requests_.end());
+    requests_.clear();
+    in_flight_ = 0;
+  }
+  for (auto *request : failed) {
+    request->callback_(error);
+    delete request;
+  }
+  completed_cv_.notify_all();
+}
+
+void IoUringAsyncIo::CompletionLoop() {
+  while (true) {
+    if (IoUringEnter(ring_fd_, 0, 1, IORING_ENTER_GETEVENTS) < 0 && !IsTransient(errno)) {
+      // nothing completes any more, fail what is in flight instead of leaving its waiters hanging
+      const int error = errno;
+      LOG_DEBUG("io_uring failed, failing the requests in flight");
+      FailAll(-error);
+      return;
+    }
+    unsigned head = *cq_head_;
+    const unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+    bool stop = false;
+    std::vector<AsyncIoRequest *> completed;
+    for (; head != tail; ++head) {
+      const io_uring_cqe &cqe = cqes_[head & *cq_mask_];
+      auto *request = reinterpret_cast<AsyncIoRequest *>(cqe.user_data);
+      ssize_t result = cqe.res;
+      if (request == nullptr) {
+        stop = true;
+        continue;
+      }
+      if (result > 0 && !request->Advance(result)) {
+        // a partial transfer, issue the rest
+        std::scoped_lock lock(sq_latch_);
+        result = PushSubmission(request);
+        if (result == 0) {
+          continue;
+        }
+      }
+      if (result == 0 && request->is_write_) {
+        result = -EIO;
+      }
+      request->callback_(result < 0 ? result : request->transferred_);
+      completed.push_back(request);
+    }
+    __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+    if (!completed.empty()) {
+      {
+        std::scoped_lock lock(sq_latch_);
+        in_flight_ -= completed.size();
+        // out of requests_ before they are freed, a new request may get the same address
+        for (auto *request : completed) {
+          requests_.erase(request);
+        }
+      }
+      for (auto *request : completed) {
+        delete request;
+      }
+      completed_cv_.notify_all();
+    }
+    if (stop) {
+      return;
+    }
+  }
+}
+
+}  // namespace bustub
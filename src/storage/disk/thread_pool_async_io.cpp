@@ -0,0 +1,89 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// thread_pool_async_io.cpp
+//
+// Identification: src/storage/disk/thread_pool_async_io.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/thread_pool_async_io.h"
+
+#include <sys/uio.h>
+
+#include <cerrno>
+#include <utility>
+
+namespace bustub {
+
+ThreadPoolAsyncIo::ThreadPoolAsyncIo(size_t num_workers, size_t queue_depth) : queue_depth_(queue_depth) {
+  workers_.reserve(num_workers);
+  for (size_t i = 0; i < num_workers; ++i) {
+    workers_.emplace_back(&ThreadPoolAsyncIo::WorkerLoop, this);
+  }
+}
+
+ThreadPoolAsyncIo::~ThreadPoolAsyncIo() {
+  {
+    std::scoped_lock lock(latch_);
+    stop_ = true;
+  }
+  queued_cv_.notify_all();
+  for (auto &worker : workers_) {
+    worker.join();
+  }
+}
+
+void ThreadPoolAsyncIo::Submit(AsyncIoRequest request) {
+  {
+    std::unique_lock lock(latch_);
+    room_cv_.wait(lock, [&] { return queue_.size() < queue_depth_; });
+    queue_.push_back(std::move(request));
+  }
+  queued_cv_.notify_one();
+}
+
+void ThreadPoolAsyncIo::WorkerLoop() {
+  std::unique_lock lock(latch_);
+  while (true) {
+    queued_cv_.wait(lock, [&] { return stop_ || !queue_.empty(); });
+    if (queue_.empty()) {
+      // stop_ is set and every request is served
+      return;
+    }
+    AsyncIoRequest request = std::move(queue_.front());
+    queue_.pop_front();
+    lock.unlock();
+    room_cv_.notify_one();
+
+    ssize_t result = 0;
+    bool done = request.iovs_.empty();
+    while (!done) {
+      const iovec *iov = request.iovs_.data() + request.iov_index_;
+      const int iov_count = request.NextChunk();
+      result = request.is_write_ ? pwritev(request.fd_, iov, iov_count, request.offset_)
+                                 : preadv(request.fd_, iov, iov_count, request.offset_);
+      if (result < 0 && errno == EINTR) {
+        continue;
+      }
+      if (result < 0) {
+        result = -errno;
+        break;
+      }
+      if (result == 0 && request.is_write_) {
+        // a write that makes no progress is an error
+        result = -EIO;
+        break;
+      }
+      done = request.Advance(result);
+    }
+    request.callback_(result < 0 ? result : request.transferred_);
+
+    lock.lock();
+  }
+}
+
+}  // namespace bustub
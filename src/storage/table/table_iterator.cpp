@@ -16,10 +16,12 @@
 
 namespace bustub {
 
-TableIterator::TableIterator(TableHeap *table_heap, RID rid, Transaction *txn)
-    : table_heap_(table_heap), tuple_(new Tuple(rid)), txn_(txn) {
+TableIterator::TableIterator(TableHeap *table_heap, RID rid, Transaction *txn, BufferAccessStrategy *strategy)
+    : table_heap_(table_heap), tuple_(new Tuple(rid)), txn_(txn), strategy_(strategy) {
   if (rid.GetPageId() != INVALID_PAGE_ID) {
     table_heap_->GetTuple(tuple_->rid_, tuple_, txn_);
+    AdvanceReadAhead(rid.GetPageId());
+    ReadAhead();
   }
 }
 
@@ -35,7 +37,8 @@ Tuple *TableIterator::operator->() {
 
 TableIterator &TableIterator::operator++() {
   BufferPoolManager *buffer_pool_manager = table_heap_->buffer_pool_manager_;
-  auto cur_page = static_cast<TablePage *>(buffer_pool_manager->FetchPage(tuple_->rid_.GetPageId()));
+  auto cur_page =
+      static_cast<TablePage *>(buffer_pool_manager->FetchPageWithStrategy(tuple_->rid_.GetPageId(), strategy_));
   cur_page->RLatch();
   assert(cur_page != nullptr);  // all pages are pinned
 
@@ -43,11 +46,13 @@ TableIterator &TableIterator::operator++() {
   if (!cur_page->GetNextTupleRid(tuple_->rid_,
                                  &next_tuple_rid)) {  // end of this page
     while (cur_page->GetNextPageId() != INVALID_PAGE_ID) {
-      auto next_page = static_cast<TablePage *>(buffer_pool_manager->FetchPage(cur_page->GetNextPageId()));
+      auto next_page =
+          static_cast<TablePage *>(buffer_pool_manager->FetchPageWithStrategy(cur_page->GetNextPageId(), strategy_));
       cur_page->RUnlatch();
       buffer_pool_manager->UnpinPage(cur_page->GetTablePageId(), false);
       cur_page = next_page;
       cur_page->RLatch();
+      AdvanceReadAhead(cur_page->GetTablePageId());
       if (cur_page->GetFirstTupleRid(&next_tuple_rid)) {
         break;
       }
@@ -61,6 +66,9 @@ TableIterator &TableIterator::operator++() {
   // release until copy the tuple
   cur_page->RUnlatch();
   buffer_pool_manager->UnpinPage(cur_page->GetTablePageId(), false);
+  if (*this != table_heap_->End()) {
+    ReadAhead();
+  }
   return *this;
 }
 
@@ -70,4 +78,38 @@ TableIterator TableIterator::operator++(int) {
   return clone;
 }
 
+void TableIterator::AdvanceReadAhead(page_id_t page_id) {
+  if (read_ahead_pages_ > 0) {
+    read_ahead_pages_--;
+  } else {
+    read_ahead_tail_ = page_id;
+  }
+}
+
+void TableIterator::ReadAhead() {
+  BufferPoolManager *buffer_pool_manager = table_heap_->buffer_pool_manager_;
+  const size_t window = read_ahead_window;
+  // The tail is the current page as long as nothing is in flight, otherwise only follow it once it has arrived.
+  // Peeking at it neither waits for a read nor makes it look hot to the replacer.
+  while (read_ahead_pages_ < window && read_ahead_tail_ != INVALID_PAGE_ID) {
+    page_id_t next_page_id = INVALID_PAGE_ID;
+    const bool resident = buffer_pool_manager->PeekResidentPage(read_ahead_tail_, [&](Page *page) {
+      page->RLatch();
+      next_page_id = static_cast<TablePage *>(page)->GetNextPageId();
+      page->RUnlatch();
+    });
+    if (!resident) {
+      return;
+    }
+    if (next_page_id == INVALID_PAGE_ID) {
+      // End of the table for now. Start over from the current page once the scan catches up, the table may grow.
+      read_ahead_tail_ = INVALID_PAGE_ID;
+      return;
+    }
+    buffer_pool_manager->PrefetchPage(next_page_id, strategy_);
+    read_ahead_tail_ = next_page_id;
+    read_ahead_pages_++;
+  }
+}
+
 }  // namespace bustub
@@ -0,0 +1,106 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// arc_replacer_test.cpp
+//
+// Identification: test/buffer/arc_replacer_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+#include <vector>
+
+#include "buffer/arc_replacer.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+TEST(ARCReplacerTest, SampleTest) {
+  ARCReplacer arc_replacer(4);
+
+  // Scenario: load pages 10-13 into frames 0-3 and use each once, then use page 11 a second time.
+  for (frame_id_t i = 0; i < 4; ++i) {
+    arc_replacer.AssignPage(i, 10 + i);
+    arc_replacer.Pin(i);
+    arc_replacer.Unpin(i);
+  }
+  arc_replacer.Pin(1);
+  arc_replacer.Unpin(1);
+  EXPECT_EQ(4, arc_replacer.Size());
+  EXPECT_EQ(0, arc_replacer.GetTargetRecencySize());
+
+  // Scenario: pages used once go first, page 11 is frequent.
+  std::vector<frame_id_t> victims;
+  arc_replacer.PeekVictims(4, &victims);
+  EXPECT_EQ((std::vector<frame_id_t>{0, 2, 3, 1}), victims);
+  int value;
+  arc_replacer.Victim(&value);
+  EXPECT_EQ(0, value);
+  arc_replacer.Victim(&value);
+  EXPECT_EQ(2, value);
+
+  // Scenario: page 10 comes back while it is still remembered. The recency side was too small, so it grows, and the
+  // page is frequent from now on.
+  arc_replacer.AssignPage(0, 10);
+  arc_replacer.Pin(0);
+  arc_replacer.Unpin(0);
+  EXPECT_EQ(1, arc_replacer.GetTargetRecencySize());
+
+  // Scenario: with page 13 alone on the recency side, which is at its target size, the least recently used frequent
+  // page goes. Once it comes back the recency side shrinks again.
+  arc_replacer.Victim(&value);
+  EXPECT_EQ(1, value);
+  arc_replacer.AssignPage(2, 11);
+  arc_replacer.Pin(2);
+  EXPECT_EQ(0, arc_replacer.GetTargetRecencySize());
+  EXPECT_EQ(2, arc_replacer.Size());
+
+  // Scenario: a pinned frame is never a victim, a removed one leaves no ghost behind.
+  arc_replacer.Remove(3);
+  arc_replacer.AssignPage(3, 13);
+  arc_replacer.Pin(3);
+  arc_replacer.Unpin(3);
+  EXPECT_EQ(0, arc_replacer.GetTargetRecencySize());
+  arc_replacer.Victim(&value);
+  EXPECT_EQ(3, value);
+  arc_replacer.Victim(&value);
+  EXPECT_EQ(0, value);
+  EXPECT_FALSE(arc_replacer.Victim(&value));
+  arc_replacer.Unpin(2);
+  arc_replacer.Victim(&value);
+  EXPECT_EQ(2, value);
+}
+
+// NOLINTNEXTLINE
+TEST(ARCReplacerTest, ScanResistanceTest) {
+  const size_t num_frames = 8;
+  ARCReplacer arc_replacer(num_frames);
+
+  // Scenario: frames 0-3 hold pages used over and over, frames 4-7 take turns holding the pages of a long scan.
+  for (frame_id_t i = 0; i < 4; ++i) {
+    arc_replacer.AssignPage(i, i);
+    arc_replacer.Pin(i);
+    arc_replacer.Unpin(i);
+    arc_replacer.Pin(i);
+    arc_replacer.Unpin(i);
+  }
+  for (frame_id_t i = 4; i < 8; ++i) {
+    arc_replacer.AssignPage(i, 100 + i);
+    arc_replacer.Pin(i);
+    arc_replacer.Unpin(i);
+  }
+  for (page_id_t page_id = 200; page_id < 1000; ++page_id) {
+    int value;
+    ASSERT_TRUE(arc_replacer.Victim(&value));
+    ASSERT_GE(value, 4);
+    arc_replacer.AssignPage(value, page_id);
+    arc_replacer.Pin(value);
+    arc_replacer.Unpin(value);
+  }
+  EXPECT_EQ(num_frames, arc_replacer.Size());
+}
+
+}  // namespace bustub
@@ -11,17 +11,25 @@
 //===----------------------------------------------------------------------===//
 
 #include "buffer/buffer_pool_manager_instance.h"
+#include <chrono>  // NOLINT
+#include <cstdint>
 #include <cstdio>
+#include <cstring>
+#include <fstream>
 #include <random>
 #include <string>
+#include <thread>  // NOLINT
+#include <vector>
 #include "buffer/buffer_pool_manager.h"
+#include "common/exception.h"
 #include "gtest/gtest.h"
+#include "recovery/log_manager.h"
 
 namespace bustub {
 
 // NOLINTNEXTLINE
 // Check whether pages containing terminal characters can be recovered
-TEST(BufferPoolManagerInstanceTest, DISABLED_BinaryDataTest) {
+TEST(BufferPoolManagerInstanceTest, BinaryDataTest) {
   const std::string db_name = "test.db";
   const size_t buffer_pool_size = 10;
 
@@ -72,9 +80,9 @@ TEST(BufferPoolManagerInstanceTest, DISABLED_BinaryDataTest) {
     EXPECT_NE(nullptr, bpm->NewPage(&page_id_temp));
     bpm->UnpinPage(page_id_temp, false);
   }
-  // Scenario: We should be able to fetch the data we wrote a while ago.
+  // Scenario: We should be able to fetch the data we wrote a while ago. The end of the page holds its checksum.
   page0 = bpm->FetchPage(0);
-  EXPECT_EQ(0, memcmp(page0->GetData(), random_binary_data, PAGE_SIZE));
+  EXPECT_EQ(0, memcmp(page0->GetData(), random_binary_data, PAGE_CHECKSUM_OFFSET));
   EXPECT_EQ(true, bpm->UnpinPage(0, true));
 
   // Shutdown the disk manager and remove the temporary file we created.
@@ -86,7 +94,7 @@ TEST(BufferPoolManagerInstanceTest, DISABLED_BinaryDataTest) {
 }
 
 // NOLINTNEXTLINE
-TEST(BufferPoolManagerInstanceTest, DISABLED_SampleTest) {
+TEST(BufferPoolManagerInstanceTest, SampleTest) {
   const std::string db_name = "test.db";
   const size_t buffer_pool_size = 10;
 
@@ -141,4 +149,954 @@ TEST(BufferPoolManagerInstanceTest, DISABLED_SampleTest) {
   delete disk_manager;
 }
 
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, ConcurrentFetchTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 16;
+  const page_id_t num_pages = 64;
+  const int num_threads = 8;
+  const int num_fetches = 5000;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  page_id_t page_id_temp;
+  for (page_id_t i = 0; i < num_pages; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "%d", page_id_temp);
+    bpm->UnpinPage(page_id_temp, true);
+  }
+
+  // Scenario: threads hammer a hot set of four resident pages, mixed with misses that keep evicting the rest.
+  // Every fetch must return the page that was asked for, and no pin may leak.
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; ++t) {
+    threads.emplace_back([bpm, t] {
+      std::default_random_engine rng(t);
+      std::uniform_int_distribution<page_id_t> page_dist(0, num_pages - 1);
+      for (int i = 0; i < num_fetches; ++i) {
+        page_id_t page_id = i % 2 == 0 ? i % 4 : page_dist(rng);
+        auto *page = bpm->FetchPage(page_id);
+        if (page == nullptr) {
+          continue;
+        }
+        EXPECT_EQ(page_id, page->GetPageId());
+        EXPECT_EQ(std::to_string(page_id), page->GetData());
+        EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  // Scenario: with every pin released, the whole pool can be claimed by new pages.
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, PrefetchTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < buffer_pool_size * 2; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "%d", page_id_temp);
+    bpm->UnpinPage(page_id_temp, true);
+  }
+
+  // Scenario: page 0 has been evicted. A prefetch hint brings it back in the background without pinning it.
+  EXPECT_FALSE(bpm->IsResident(0));
+  const int reads_before = disk_manager->GetNumReads();
+  bpm->PrefetchPage(0);
+  for (int i = 0; i < 1000 && !bpm->IsResident(0); ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  ASSERT_TRUE(bpm->IsResident(0));
+  EXPECT_EQ(reads_before + 1, disk_manager->GetNumReads());
+
+  // Scenario: fetching the prefetched page is a hit.
+  auto *page0 = bpm->FetchPage(0);
+  ASSERT_NE(nullptr, page0);
+  EXPECT_EQ(0, strcmp(page0->GetData(), "0"));
+  EXPECT_EQ(reads_before + 1, disk_manager->GetNumReads());
+  EXPECT_EQ(1, page0->GetPinCount());
+  EXPECT_TRUE(bpm->UnpinPage(0, false));
+
+  // Scenario: hints for resident pages are ignored.
+  bpm->PrefetchPage(0);
+  EXPECT_EQ(reads_before + 1, disk_manager->GetNumReads());
+
+  // Scenario: peeking at a resident page is not a hit and leaves it unpinned, peeking at an evicted one reads nothing.
+  const uint64_t hits_before = bpm->GetStats().hits_;
+  std::string data;
+  EXPECT_TRUE(bpm->PeekResidentPage(0, [&](Page *page) {
+    EXPECT_EQ(1, page->GetPinCount());
+    data = page->GetData();
+  }));
+  EXPECT_EQ("0", data);
+  EXPECT_EQ(hits_before, bpm->GetStats().hits_);
+  EXPECT_FALSE(bpm->IsResident(1));
+  EXPECT_FALSE(bpm->PeekResidentPage(1, [&](Page *page) { ADD_FAILURE(); }));
+  EXPECT_EQ(reads_before + 1, disk_manager->GetNumReads());
+  page0 = bpm->FetchPage(0);
+  ASSERT_NE(nullptr, page0);
+  EXPECT_EQ(1, page0->GetPinCount());
+  EXPECT_TRUE(bpm->UnpinPage(0, false));
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, BackgroundWriterTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+  const auto old_interval = background_writer_interval;
+  background_writer_interval = std::chrono::milliseconds(1);
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "%d", page_id_temp);
+  }
+  // Scenario: keep page 0 pinned. The background writer must only clean the unpinned pages.
+  for (page_id_t i = 1; i < static_cast<page_id_t>(buffer_pool_size); ++i) {
+    EXPECT_TRUE(bpm->UnpinPage(i, true));
+  }
+  auto all_clean = [bpm] {
+    for (size_t i = 0; i < buffer_pool_size; ++i) {
+      Page *page = &bpm->GetPages()[i];
+      if (page->GetPageId() != 0 && page->IsDirty()) {
+        return false;
+      }
+    }
+    return true;
+  };
+  for (int i = 0; i < 1000 && !all_clean(); ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  ASSERT_TRUE(all_clean());
+  EXPECT_EQ(buffer_pool_size - 1, disk_manager->GetNumWrites());
+  EXPECT_EQ(0, strcmp(bpm->FetchPage(0)->GetData(), "0"));
+  EXPECT_TRUE(bpm->UnpinPage(0, true));
+  EXPECT_TRUE(bpm->UnpinPage(0, true));
+
+  // Scenario: the cleaned pages come back from disk intact after being evicted.
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_TRUE(bpm->UnpinPage(page_id_temp, false));
+  }
+  for (page_id_t i = 0; i < static_cast<page_id_t>(buffer_pool_size); ++i) {
+    auto *page = bpm->FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(std::to_string(i), page->GetData());
+    EXPECT_TRUE(bpm->UnpinPage(i, false));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+  background_writer_interval = old_interval;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, AccessStrategyTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 64;
+  const size_t ring_size = buffer_pool_size / 8;
+  const size_t num_bulk_pages = 200;
+  const size_t num_hot_pages = buffer_pool_size - ring_size;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  auto count_resident = [&](page_id_t first, size_t count) {
+    size_t resident = 0;
+    for (size_t i = 0; i < count; ++i) {
+      resident += bpm->IsResident(first + static_cast<page_id_t>(i)) ? 1 : 0;
+    }
+    return resident;
+  };
+
+  // Scenario: a bulk load writes far more pages than the pool holds, but only ever occupies its ring.
+  page_id_t page_id_temp;
+  {
+    BufferAccessStrategy strategy(bpm, BufferAccessStrategyType::BULK_WRITE);
+    for (size_t i = 0; i < num_bulk_pages; ++i) {
+      auto *page = bpm->NewPageWithStrategy(&page_id_temp, &strategy);
+      ASSERT_NE(nullptr, page);
+      snprintf(page->GetData(), PAGE_SIZE, "%d", page_id_temp);
+      EXPECT_TRUE(bpm->UnpinPage(page_id_temp, true));
+    }
+  }
+  EXPECT_GE(ring_size, count_resident(0, num_bulk_pages));
+
+  // Fill the rest of the pool with a hot working set.
+  const auto first_hot_page = static_cast<page_id_t>(num_bulk_pages);
+  for (size_t i = 0; i < num_hot_pages; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_TRUE(bpm->UnpinPage(page_id_temp, true));
+  }
+  EXPECT_EQ(num_hot_pages, count_resident(first_hot_page, num_hot_pages));
+
+  // Scenario: scanning the bulk loaded pages through a ring reads back what was written and leaves the hot pages be.
+  {
+    BufferAccessStrategy strategy(bpm, BufferAccessStrategyType::BULK_READ);
+    for (size_t i = 0; i < num_bulk_pages; ++i) {
+      auto page_id = static_cast<page_id_t>(i);
+      auto *page = bpm->FetchPageWithStrategy(page_id, &strategy);
+      ASSERT_NE(nullptr, page);
+      EXPECT_EQ(page_id, std::stoi(page->GetData()));
+      EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+    }
+  }
+  EXPECT_EQ(num_hot_pages, count_resident(first_hot_page, num_hot_pages));
+
+  // Scenario: the same scan without a strategy flushes the hot pages out.
+  for (size_t i = 0; i < num_bulk_pages; ++i) {
+    auto page_id = static_cast<page_id_t>(i);
+    ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+  EXPECT_EQ(0, count_resident(first_hot_page, num_hot_pages));
+
+  // Scenario: only a relation over a quarter of the pool is worth a ring.
+  EXPECT_FALSE(BufferAccessStrategy::IsLargeRelation(bpm, buffer_pool_size / 4));
+  EXPECT_TRUE(BufferAccessStrategy::IsLargeRelation(bpm, buffer_pool_size / 4 + 1));
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+
+  // Scenario: in a pool too small for an eighth of it to hold the read-ahead window, the ring still holds it.
+  const size_t small_pool_size = 8;
+  disk_manager = new DiskManager(db_name);
+  bpm = new BufferPoolManagerInstance(small_pool_size, disk_manager);
+  {
+    BufferAccessStrategy strategy(bpm, BufferAccessStrategyType::BULK_READ);
+    for (size_t i = 0; i < num_bulk_pages; ++i) {
+      ASSERT_NE(nullptr, bpm->NewPageWithStrategy(&page_id_temp, &strategy));
+      EXPECT_TRUE(bpm->UnpinPage(page_id_temp, false));
+    }
+    EXPECT_EQ(read_ahead_window.load() + 1, count_resident(0, num_bulk_pages));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, FrameLayoutTest) {
+  const std::string db_name = "test.db";
+  // Large enough for the frames to be backed by huge pages.
+  const size_t buffer_pool_size = 2 * FrameArena::HUGE_PAGE_SIZE / PAGE_SIZE;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  // Scenario: frame data is page aligned and contiguous, the book-keeping of a frame never shares a cache line.
+  Page *pages = bpm->GetPages();
+  const auto base = reinterpret_cast<uintptr_t>(pages[0].GetData());
+  EXPECT_EQ(0, base % FrameArena::HUGE_PAGE_SIZE);
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    EXPECT_EQ(base + i * PAGE_SIZE, reinterpret_cast<uintptr_t>(pages[i].GetData()));
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(&pages[i]) % 64);
+  }
+
+  // Scenario: the frames behave like before.
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < buffer_pool_size + 1; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(page->GetData()) % PAGE_SIZE);
+    snprintf(page->GetData(), PAGE_SIZE, "%d", page_id_temp);
+    EXPECT_TRUE(bpm->UnpinPage(page_id_temp, true));
+  }
+  auto *page0 = bpm->FetchPage(0);
+  ASSERT_NE(nullptr, page0);
+  EXPECT_EQ(0, strcmp(page0->GetData(), "0"));
+  EXPECT_TRUE(bpm->UnpinPage(0, false));
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, ResizeTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+  const size_t max_pool_size = 20;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, nullptr, ReplacerType::LRU, max_pool_size);
+
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "%d", page_id_temp);
+  }
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+
+  // Scenario: growing makes room for more pinned pages right away, and never beyond the maximum.
+  EXPECT_FALSE(bpm->ResizePool(max_pool_size + 1));
+  EXPECT_TRUE(bpm->ResizePool(max_pool_size));
+  EXPECT_EQ(max_pool_size, bpm->GetPoolSize());
+  for (size_t i = buffer_pool_size; i < max_pool_size; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "%d", page_id_temp);
+  }
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+
+  // Scenario: shrinking gives up when the pages to be dropped stay pinned, and leaves the size alone.
+  const auto timeout = buffer_pool_resize_timeout;
+  buffer_pool_resize_timeout = std::chrono::milliseconds(10);
+  EXPECT_FALSE(bpm->ResizePool(5));
+  EXPECT_EQ(max_pool_size, bpm->GetPoolSize());
+
+  // Scenario: shrinking waits for pages to be unpinned, while the rest of the pool stays usable.
+  buffer_pool_resize_timeout = std::chrono::milliseconds(10000);
+  std::thread unpinner([&] {
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(max_pool_size); ++page_id) {
+      EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+    }
+  });
+  EXPECT_TRUE(bpm->ResizePool(5));
+  unpinner.join();
+  buffer_pool_resize_timeout = timeout;
+  EXPECT_EQ(5, bpm->GetPoolSize());
+  size_t resident = 0;
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(max_pool_size); ++page_id) {
+    resident += bpm->IsResident(page_id) ? 1 : 0;
+  }
+  EXPECT_GE(5, resident);
+
+  // Scenario: pages evicted by the shrink were written back, and only 5 frames are left to pin.
+  for (page_id_t page_id = 0; page_id < 5; ++page_id) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(page_id, std::stoi(page->GetData()));
+  }
+  EXPECT_EQ(nullptr, bpm->FetchPage(5));
+  for (page_id_t page_id = 0; page_id < 5; ++page_id) {
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+  for (page_id_t page_id = 5; page_id < static_cast<page_id_t>(max_pool_size); ++page_id) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(page_id, std::stoi(page->GetData()));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, WarmRestartTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+  const bool enabled = enable_buffer_pool_dump;
+  enable_buffer_pool_dump = true;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  const std::string dump_file_name = bpm->GetDumpFileName();
+  remove(dump_file_name.c_str());
+
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < buffer_pool_size * 3; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "%d", page_id_temp);
+    EXPECT_TRUE(bpm->UnpinPage(page_id_temp, true));
+  }
+  // Pages 20 to 29 are resident, make the first half the hottest.
+  for (page_id_t page_id = 20; page_id < 25; ++page_id) {
+    ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+
+  // Scenario: shutting down saves the resident pages.
+  bpm->FlushAllPages();
+  delete bpm;
+  std::ifstream dump(dump_file_name);
+  EXPECT_TRUE(dump.good());
+  dump.close();
+
+  // Scenario: a smaller pool warms up with the hottest pages in the background, and fetching them is a hit.
+  const auto interval = buffer_pool_dump_interval;
+  buffer_pool_dump_interval = std::chrono::milliseconds(1);
+  bpm = new BufferPoolManagerInstance(buffer_pool_size / 2, disk_manager);
+  auto all_resident = [&] {
+    for (page_id_t page_id = 20; page_id < 25; ++page_id) {
+      if (!bpm->IsResident(page_id)) {
+        return false;
+      }
+    }
+    return true;
+  };
+  for (int i = 0; i < 1000 && !all_resident(); ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  ASSERT_TRUE(all_resident());
+  for (page_id_t page_id = 25; page_id < 30; ++page_id) {
+    EXPECT_FALSE(bpm->IsResident(page_id));
+  }
+  const int reads_before = disk_manager->GetNumReads();
+  for (page_id_t page_id = 20; page_id < 25; ++page_id) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(page_id, std::stoi(page->GetData()));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+  EXPECT_EQ(reads_before, disk_manager->GetNumReads());
+
+  // Scenario: the dump is refreshed periodically while the pool is running.
+  remove(dump_file_name.c_str());
+  bool dumped = false;
+  for (int i = 0; i < 1000 && !dumped; ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    dumped = std::ifstream(dump_file_name).good();
+  }
+  EXPECT_TRUE(dumped);
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+  buffer_pool_dump_interval = interval;
+  enable_buffer_pool_dump = enabled;
+  remove(dump_file_name.c_str());
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, FreePageReuseTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(static_cast<page_id_t>(i), page_id_temp);
+    EXPECT_TRUE(bpm->UnpinPage(page_id_temp, true));
+  }
+
+  // Scenario: deleted pages are handed out again, the lowest one first.
+  EXPECT_TRUE(bpm->DeletePage(3));
+  EXPECT_TRUE(bpm->DeletePage(7));
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_EQ(3, page_id_temp);
+  EXPECT_TRUE(bpm->UnpinPage(page_id_temp, true));
+
+  // Scenario: with a hint, the closest free page wins, unless growing the file lands closer.
+  ASSERT_NE(nullptr, bpm->NewPageNear(&page_id_temp, 8));
+  EXPECT_EQ(7, page_id_temp);
+  EXPECT_TRUE(bpm->UnpinPage(page_id_temp, true));
+  ASSERT_NE(nullptr, bpm->NewPageNear(&page_id_temp, 8));
+  EXPECT_EQ(10, page_id_temp);
+  EXPECT_TRUE(bpm->UnpinPage(page_id_temp, true));
+  EXPECT_TRUE(bpm->DeletePage(1));
+  ASSERT_NE(nullptr, bpm->NewPageNear(&page_id_temp, 10));
+  EXPECT_EQ(11, page_id_temp);
+  EXPECT_TRUE(bpm->UnpinPage(page_id_temp, true));
+
+  // Scenario: deleting a page twice does not hand it out twice.
+  EXPECT_TRUE(bpm->DeletePage(2));
+  EXPECT_TRUE(bpm->DeletePage(2));
+
+  // Scenario: the free pages survive a restart.
+  bpm->FlushAllPages();
+  delete bpm;
+  bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_EQ(1, page_id_temp);
+  EXPECT_TRUE(bpm->UnpinPage(page_id_temp, true));
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_EQ(2, page_id_temp);
+  EXPECT_TRUE(bpm->UnpinPage(page_id_temp, true));
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_EQ(12, page_id_temp);
+  EXPECT_TRUE(bpm->UnpinPage(page_id_temp, true));
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.fsm0");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, FetchPagesTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 5;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < buffer_pool_size * 2; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "%d", page_id_temp);
+    EXPECT_TRUE(bpm->UnpinPage(page_id_temp, true));
+  }
+
+  // Scenario: a batch mixing hits, misses and a duplicate reads every miss once.
+  std::vector<page_id_t> page_ids{9, 0, 2, 1, 2};
+  std::vector<Page *> pages(page_ids.size());
+  const int reads_before = disk_manager->GetNumReads();
+  EXPECT_TRUE(bpm->FetchPages(page_ids, pages.data()));
+  EXPECT_EQ(reads_before + 3, disk_manager->GetNumReads());
+  for (size_t i = 0; i < page_ids.size(); ++i) {
+    ASSERT_NE(nullptr, pages[i]);
+    EXPECT_EQ(page_ids[i], pages[i]->GetPageId());
+    EXPECT_EQ(page_ids[i], std::stoi(pages[i]->GetData()));
+  }
+  EXPECT_EQ(pages[2], pages[4]);
+  EXPECT_EQ(2, pages[2]->GetPinCount());
+
+  // Scenario: with one frame left, the first miss gets it and the other comes back empty.
+  page_ids = {5, 9, 6};
+  EXPECT_FALSE(bpm->FetchPages(page_ids, pages.data()));
+  ASSERT_NE(nullptr, pages[0]);
+  EXPECT_EQ(5, std::stoi(pages[0]->GetData()));
+  ASSERT_NE(nullptr, pages[1]);
+  EXPECT_EQ(2, pages[1]->GetPinCount());
+  EXPECT_EQ(nullptr, pages[2]);
+
+  // Every fetched page was pinned once per occurrence.
+  for (page_id_t page_id : {9, 9, 0, 2, 2, 1, 5}) {
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+  for (page_id_t page_id : {9, 0, 2, 1, 5}) {
+    EXPECT_FALSE(bpm->UnpinPage(page_id, false));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.fsm0");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, CorruptPageTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 3;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < buffer_pool_size * 2; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "%d", page_id_temp);
+    EXPECT_TRUE(bpm->UnpinPage(page_id_temp, true));
+  }
+  bpm->FlushAllPages();
+
+  // Damage page 1, which is not resident, on disk.
+  std::fstream db_file(db_name, std::ios::binary | std::ios::in | std::ios::out);
+  db_file.seekp(PAGE_SIZE + 100);
+  db_file.put('x');
+  db_file.close();
+
+  // Scenario: fetching the page fails, and the frame it was going into is not lost.
+  EXPECT_THROW(bpm->FetchPage(1), CorruptionException);
+  EXPECT_EQ(buffer_pool_size, bpm->GetNumAvailableFrames());
+
+  // Scenario: a batch with the page fails as a whole and leaves nothing pinned.
+  std::vector<page_id_t> page_ids{0, 4, 1};
+  std::vector<Page *> pages(page_ids.size());
+  EXPECT_THROW(bpm->FetchPages(page_ids, pages.data()), CorruptionException);
+  EXPECT_EQ(nullptr, pages[1]);
+  EXPECT_FALSE(bpm->UnpinPage(4, false));
+  EXPECT_EQ(buffer_pool_size, bpm->GetNumAvailableFrames());
+
+  // Scenario: the other pages are fine.
+  auto *page = bpm->FetchPage(0);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(0, std::stoi(page->GetData()));
+  EXPECT_TRUE(bpm->UnpinPage(0, false));
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.fsm0");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, SwizzleTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 3;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  page_id_t page_id_temp;
+  auto *page0 = bpm->NewPage(&page_id_temp);
+  ASSERT_NE(nullptr, page0);
+  snprintf(page0->GetData(), PAGE_SIZE, "Hello");
+  EXPECT_TRUE(bpm->UnpinPage(page_id_temp, true));
+
+  // Scenario: the first fetch swizzles the swip, the next ones go straight to the same frame.
+  Swip swip(page_id_temp);
+  EXPECT_FALSE(swip.IsSwizzled());
+  EXPECT_EQ(page0, bpm->FetchPageSwizzled(&swip));
+  EXPECT_TRUE(swip.IsSwizzled());
+  EXPECT_EQ(page0, bpm->FetchPageSwizzled(&swip));
+  EXPECT_EQ(2, page0->GetPinCount());
+  EXPECT_TRUE(bpm->UnpinPage(0, false));
+  EXPECT_TRUE(bpm->UnpinPage(0, false));
+  frame_id_t frame_id;
+  uint32_t generation;
+  ASSERT_TRUE(swip.GetFrame(&frame_id, &generation));
+
+  // Scenario: once the page is evicted, the frame is reused by another page and the stale swip falls back to the
+  // page id, getting the page from disk and swizzling again.
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "%d", page_id_temp);
+    EXPECT_TRUE(bpm->UnpinPage(page_id_temp, true));
+  }
+  EXPECT_FALSE(bpm->IsResident(0));
+  auto *page = bpm->FetchPageSwizzled(&swip);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(0, page->GetPageId());
+  EXPECT_EQ(0, strcmp(page->GetData(), "Hello"));
+  frame_id_t new_frame_id;
+  uint32_t new_generation;
+  ASSERT_TRUE(swip.GetFrame(&new_frame_id, &new_generation));
+  EXPECT_TRUE(new_frame_id != frame_id || new_generation != generation);
+  EXPECT_TRUE(bpm->UnpinPage(0, false));
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.fsm0");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, HitOrderTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 3;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_TRUE(bpm->UnpinPage(page_id_temp, false));
+  }
+
+  // Scenario: hits reach the replacer late, in batches, but still in the order they happened. Pages 0 to 2 sit in
+  // page table stripes 0 to 2, and are hit in the opposite order, so the least recently used one is page 2.
+  for (page_id_t page_id : {1, 0}) {
+    ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_TRUE(bpm->UnpinPage(page_id_temp, false));
+  EXPECT_FALSE(bpm->IsResident(2));
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_TRUE(bpm->UnpinPage(page_id_temp, false));
+  EXPECT_FALSE(bpm->IsResident(1));
+  EXPECT_TRUE(bpm->IsResident(0));
+
+  // Scenario: a page hit more often than the queue of a stripe holds is still only evicted once unpinned.
+  auto *page0 = bpm->FetchPage(0);
+  ASSERT_NE(nullptr, page0);
+  for (size_t i = 0; i < 1000; ++i) {
+    ASSERT_NE(nullptr, bpm->FetchPage(0));
+    EXPECT_TRUE(bpm->UnpinPage(0, false));
+  }
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_TRUE(bpm->UnpinPage(page_id_temp, false));
+  }
+  EXPECT_TRUE(bpm->IsResident(0));
+  EXPECT_TRUE(bpm->UnpinPage(0, false));
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.fsm0");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, WriteAheadLogTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 2;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *log_manager = new LogManager(disk_manager);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, log_manager);
+  enable_logging = true;
+
+  // Changes a page the way a logged operation does, with a record that is not durable yet.
+  auto log_change = [&](Page *page) {
+    LogRecord record(0, INVALID_LSN, LogRecordType::BEGIN);
+    const lsn_t lsn = log_manager->AppendLogRecord(&record);
+    page->SetLSN(lsn);
+    EXPECT_LT(log_manager->GetPersistentLSN(), lsn);
+    return lsn;
+  };
+
+  // Scenario: evicting a dirty page makes the log durable up to the page first.
+  page_id_t page_id_temp;
+  auto *page = bpm->NewPage(&page_id_temp);
+  ASSERT_NE(nullptr, page);
+  lsn_t lsn = log_change(page);
+  EXPECT_TRUE(bpm->UnpinPage(page_id_temp, true));
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_TRUE(bpm->UnpinPage(page_id_temp, false));
+  }
+  EXPECT_FALSE(bpm->IsResident(0));
+  EXPECT_LE(lsn, log_manager->GetPersistentLSN());
+
+  // Scenario: so does flushing a page, or all of them.
+  page = bpm->FetchPage(page_id_temp);
+  ASSERT_NE(nullptr, page);
+  lsn = log_change(page);
+  EXPECT_TRUE(bpm->UnpinPage(page_id_temp, true));
+  EXPECT_TRUE(bpm->FlushPage(page_id_temp));
+  EXPECT_LE(lsn, log_manager->GetPersistentLSN());
+  page = bpm->FetchPage(page_id_temp);
+  ASSERT_NE(nullptr, page);
+  lsn = log_change(page);
+  EXPECT_TRUE(bpm->UnpinPage(page_id_temp, true));
+  bpm->FlushAllPages();
+  EXPECT_LE(lsn, log_manager->GetPersistentLSN());
+
+  // Scenario: a page that is not logged has no LSN to wait for, whatever it keeps in its place.
+  page = bpm->FetchPage(page_id_temp);
+  ASSERT_NE(nullptr, page);
+  page->SetLSN(log_manager->GetNextLSN() + 100);
+  EXPECT_TRUE(bpm->UnpinPage(page_id_temp, true));
+  EXPECT_TRUE(bpm->FlushPage(page_id_temp));
+
+  enable_logging = false;
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.log");
+  remove("test.fsm0");
+
+  delete bpm;
+  delete log_manager;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, StatsTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 3;
+  // Keep the background writer out of the way, so that every dirty victim is written back by the thread evicting it.
+  const size_t bg_writer_max_pages = background_writer_max_pages;
+  background_writer_max_pages = 0;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  }
+  // Scenario: a request that finds every frame pinned is a pin wait.
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_EQ(nullptr, bpm->FetchPage(10));
+  auto stats = bpm->GetStats();
+  EXPECT_EQ(2, stats.pin_waits_);
+  EXPECT_EQ(0, stats.hits_);
+  EXPECT_EQ(0, stats.misses_);
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(buffer_pool_size); ++page_id) {
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+
+  // Scenario: hits, misses, evictions and dirty write-backs.
+  ASSERT_NE(nullptr, bpm->FetchPage(0));
+  EXPECT_TRUE(bpm->UnpinPage(0, false));
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_TRUE(bpm->UnpinPage(page_id_temp, false));
+  ASSERT_NE(nullptr, bpm->FetchPage(1));
+  EXPECT_TRUE(bpm->UnpinPage(1, false));
+  stats = bpm->GetStats();
+  EXPECT_EQ(1, stats.hits_);
+  EXPECT_EQ(1, stats.misses_);
+  EXPECT_EQ(2, stats.evictions_);
+  EXPECT_EQ(2, stats.dirty_writebacks_);
+  EXPECT_EQ(0, stats.background_writes_);
+  EXPECT_DOUBLE_EQ(0.5, stats.HitRatio());
+  uint64_t latencies = 0;
+  for (auto count : stats.miss_latency_histogram_) {
+    latencies += count;
+  }
+  EXPECT_EQ(1, latencies);
+  EXPECT_GT(stats.MissLatencyPercentile(50), 0);
+
+  // Scenario: threads counting at the same time lose nothing.
+  const int num_threads = 4;
+  const int num_fetches = 1000;
+  std::vector<std::thread> threads;
+  for (int i = 0; i < num_threads; ++i) {
+    threads.emplace_back([&] {
+      for (int j = 0; j < num_fetches; ++j) {
+        ASSERT_NE(nullptr, bpm->FetchPage(1));
+        EXPECT_TRUE(bpm->UnpinPage(1, false));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(stats.hits_ + num_threads * num_fetches, bpm->GetStats().hits_);
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.fsm0");
+
+  delete bpm;
+  delete disk_manager;
+  background_writer_max_pages = bg_writer_max_pages;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, CompressedTierTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 2;
+  const size_t cache_size = compressed_page_cache_size;
+  compressed_page_cache_size = 64 * 1024;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  // Page 0 compresses well, page 1 is random and does not.
+  char text_data[PAGE_SIZE];
+  const char *text = "a page of text compresses well, ";
+  for (size_t i = 0; i < PAGE_SIZE; ++i) {
+    text_data[i] = text[i % strlen(text)];
+  }
+  char random_data[PAGE_SIZE];
+  std::mt19937 gen(15445);
+  std::uniform_int_distribution<int> dis(0, 255);
+  for (char &c : random_data) {
+    c = static_cast<char>(dis(gen));
+  }
+  page_id_t page_id_temp;
+  Page *page = bpm->NewPage(&page_id_temp);
+  ASSERT_NE(nullptr, page);
+  memcpy(page->GetData(), text_data, PAGE_SIZE);
+  EXPECT_TRUE(bpm->UnpinPage(0, true));
+  page = bpm->NewPage(&page_id_temp);
+  ASSERT_NE(nullptr, page);
+  memcpy(page->GetData(), random_data, PAGE_SIZE);
+  EXPECT_TRUE(bpm->UnpinPage(1, true));
+
+  // Scenario: evicting pages 0 and 1 keeps page 0 compressed, fetching it again does not read the disk.
+  for (int i = 0; i < 2; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_TRUE(bpm->UnpinPage(page_id_temp, false));
+  }
+  int num_reads = disk_manager->GetNumReads();
+  page = bpm->FetchPage(0);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(0, memcmp(page->GetData(), text_data, PAGE_CHECKSUM_OFFSET));
+  EXPECT_EQ(num_reads, disk_manager->GetNumReads());
+  page = bpm->FetchPage(1);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(0, memcmp(page->GetData(), random_data, PAGE_CHECKSUM_OFFSET));
+  EXPECT_EQ(num_reads + 1, disk_manager->GetNumReads());
+  auto stats = bpm->GetStats();
+  EXPECT_EQ(1, stats.compressed_hits_);
+  EXPECT_EQ(1, stats.compressed_misses_);
+  EXPECT_DOUBLE_EQ(0.5, stats.CompressedHitRatio());
+  EXPECT_GT(stats.compressed_bytes_, 0);
+  EXPECT_LT(stats.compressed_bytes_, PAGE_SIZE);
+  EXPECT_TRUE(bpm->UnpinPage(0, false));
+  EXPECT_TRUE(bpm->UnpinPage(1, false));
+
+  // Scenario: batched fetches are served from the tier as well.
+  num_reads = disk_manager->GetNumReads();
+  std::vector<page_id_t> page_ids{2, 3};
+  Page *pages[2];
+  ASSERT_TRUE(bpm->FetchPages(page_ids, pages));
+  EXPECT_EQ(num_reads, disk_manager->GetNumReads());
+  for (auto *fetched : pages) {
+    EXPECT_EQ(0, fetched->GetData()[0]);
+    EXPECT_TRUE(bpm->UnpinPage(fetched->GetPageId(), false));
+  }
+  EXPECT_EQ(3, bpm->GetStats().compressed_hits_);
+
+  // Scenario: a deleted page is dropped from the tier, its id comes back as a fresh page.
+  EXPECT_GT(bpm->GetStats().compressed_bytes_, 0);
+  ASSERT_TRUE(bpm->DeletePage(0));
+  EXPECT_EQ(0, bpm->GetStats().compressed_bytes_);
+  page = bpm->NewPage(&page_id_temp);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(0, page_id_temp);
+  EXPECT_EQ(0, page->GetData()[0]);
+  EXPECT_TRUE(bpm->UnpinPage(0, false));
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.fsm0");
+
+  delete bpm;
+  delete disk_manager;
+  compressed_page_cache_size = cache_size;
+}
+
 }  // namespace bustub
@@ -11,17 +11,29 @@
 //===----------------------------------------------------------------------===//
 
 #include "buffer/parallel_buffer_pool_manager.h"
+#include <chrono>  // NOLINT
 #include <cstdio>
+#include <fstream>
 #include <random>
 #include <string>
+#include <vector>
 #include "buffer/buffer_pool_manager.h"
+#include "common/exception.h"
+#include "common/util/numa_util.h"
 #include "gtest/gtest.h"
 
 namespace bustub {
 
+/** Remove the free page maps every instance keeps next to test.db. */
+static void RemoveFreePageMaps(size_t num_instances) {
+  for (size_t i = 0; i < num_instances; ++i) {
+    remove(("test.fsm" + std::to_string(i)).c_str());
+  }
+}
+
 // NOLINTNEXTLINE
 // Check whether pages containing terminal characters can be recovered
-TEST(ParallelBufferPoolManagerTest, DISABLED_BinaryDataTest) {
+TEST(ParallelBufferPoolManagerTest, BinaryDataTest) {
   const std::string db_name = "test.db";
   const size_t buffer_pool_size = 10;
   const size_t num_instances = 5;
@@ -74,21 +86,22 @@ TEST(ParallelBufferPoolManagerTest, DISABLED_BinaryDataTest) {
     bpm->UnpinPage(page_id_temp, false);
   }
 
-  // Scenario: We should be able to fetch the data we wrote a while ago.
+  // Scenario: We should be able to fetch the data we wrote a while ago. The end of the page holds its checksum.
   page0 = bpm->FetchPage(0);
-  EXPECT_EQ(0, memcmp(page0->GetData(), random_binary_data, PAGE_SIZE));
+  EXPECT_EQ(0, memcmp(page0->GetData(), random_binary_data, PAGE_CHECKSUM_OFFSET));
   EXPECT_EQ(true, bpm->UnpinPage(0, true));
 
   // Shutdown the disk manager and remove the temporary file we created.
   disk_manager->ShutDown();
   remove("test.db");
+  RemoveFreePageMaps(num_instances);
 
   delete bpm;
   delete disk_manager;
 }
 
 // NOLINTNEXTLINE
-TEST(ParallelBufferPoolManagerTest, DISABLED_SampleTest) {
+TEST(ParallelBufferPoolManagerTest, SampleTest) {
   const std::string db_name = "test.db";
   const size_t buffer_pool_size = 10;
   const size_t num_instances = 5;
@@ -146,9 +159,327 @@ TEST(ParallelBufferPoolManagerTest, DISABLED_SampleTest) {
   // Shutdown the disk manager and remove the temporary file we created.
   disk_manager->ShutDown();
   remove("test.db");
+  RemoveFreePageMaps(num_instances);
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, ResizeTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 5;
+  const size_t max_pool_size = 10;
+  const size_t num_instances = 4;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager, nullptr, ReplacerType::LRU,
+                                            max_pool_size);
+
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < buffer_pool_size * num_instances; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "%d", page_id_temp);
+    EXPECT_TRUE(bpm->UnpinPage(page_id_temp, true));
+  }
+
+  // Scenario: the total is spread over the instances, which keep owning the same page ids.
+  EXPECT_TRUE(bpm->ResizePool(38));
+  EXPECT_EQ(38, bpm->GetPoolSize());
+  EXPECT_FALSE(bpm->ResizePool(num_instances - 1));
+  EXPECT_FALSE(bpm->ResizePool(max_pool_size * num_instances + 1));
+  EXPECT_TRUE(bpm->ResizePool(num_instances));
+  EXPECT_EQ(num_instances, bpm->GetPoolSize());
+
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(buffer_pool_size * num_instances); ++page_id) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(page_id, std::stoi(page->GetData()));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+
+  // Scenario: when the last instance cannot shrink because its pages are pinned, the others are put back too.
+  const auto resize_timeout = buffer_pool_resize_timeout;
+  buffer_pool_resize_timeout = std::chrono::milliseconds(10);
+  EXPECT_TRUE(bpm->ResizePool(2 * num_instances));
+  const auto last_instance = static_cast<page_id_t>(num_instances - 1);
+  for (page_id_t page_id : {last_instance, last_instance + static_cast<page_id_t>(num_instances)}) {
+    ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+  }
+  EXPECT_FALSE(bpm->ResizePool(num_instances));
+  EXPECT_EQ(2 * num_instances, bpm->GetPoolSize());
+  for (page_id_t page_id : {last_instance, last_instance + static_cast<page_id_t>(num_instances)}) {
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+  EXPECT_TRUE(bpm->ResizePool(num_instances));
+  EXPECT_EQ(num_instances, bpm->GetPoolSize());
+  buffer_pool_resize_timeout = resize_timeout;
+
+  // Scenario: a size some instance cannot take is refused before any instance changes.
+  EXPECT_FALSE(bpm->ResizePool(max_pool_size * num_instances + 1));
+  EXPECT_EQ(num_instances, bpm->GetPoolSize());
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  RemoveFreePageMaps(num_instances);
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, FetchPagesTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 5;
+  const size_t num_instances = 4;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager);
+
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < buffer_pool_size * num_instances * 2; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "%d", page_id_temp);
+    EXPECT_TRUE(bpm->UnpinPage(page_id_temp, true));
+  }
+
+  // Scenario: the batch is split over the instances and the pages come back in the order they were asked for.
+  std::vector<page_id_t> page_ids{13, 0, 7, 38, 1, 4, 13};
+  std::vector<Page *> pages(page_ids.size());
+  EXPECT_TRUE(bpm->FetchPages(page_ids, pages.data()));
+  for (size_t i = 0; i < page_ids.size(); ++i) {
+    ASSERT_NE(nullptr, pages[i]);
+    EXPECT_EQ(page_ids[i], std::stoi(pages[i]->GetData()));
+  }
+  for (page_id_t page_id : page_ids) {
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  RemoveFreePageMaps(num_instances);
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, CorruptPageTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 2;
+  const size_t num_instances = 2;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager);
+
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < buffer_pool_size * num_instances * 2; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "%d", page_id_temp);
+    EXPECT_TRUE(bpm->UnpinPage(page_id_temp, true));
+  }
+  bpm->FlushAllPages();
+
+  // Damage page 1, which the second instance owns and does not hold, on disk.
+  std::fstream db_file(db_name, std::ios::binary | std::ios::in | std::ios::out);
+  db_file.seekp(PAGE_SIZE + 100);
+  db_file.put('x');
+  db_file.close();
+
+  // Scenario: the batch fails in the second instance, the pages the first one fetched are not left pinned.
+  std::vector<page_id_t> page_ids{0, 2, 1};
+  std::vector<Page *> pages(page_ids.size());
+  EXPECT_THROW(bpm->FetchPages(page_ids, pages.data()), CorruptionException);
+  EXPECT_EQ(nullptr, pages[0]);
+  EXPECT_EQ(nullptr, pages[1]);
+  for (page_id_t page_id : {4, 6}) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(page_id, std::stoi(page->GetData()));
+  }
+  EXPECT_TRUE(bpm->UnpinPage(4, false));
+  EXPECT_TRUE(bpm->UnpinPage(6, false));
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  RemoveFreePageMaps(num_instances);
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, NumaTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 5;
+  const size_t num_instances = 4;
+  const bool numa_local = enable_numa_local_allocation;
+
+  const int num_nodes = NumaUtil::NumNodes();
+  ASSERT_GE(num_nodes, 1);
+  EXPECT_GE(NumaUtil::CurrentNode(), 0);
+  EXPECT_LT(NumaUtil::CurrentNode(), num_nodes);
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager);
+
+  // Scenario: with node-local allocation every instance is still used once the local ones are full.
+  enable_numa_local_allocation = true;
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < buffer_pool_size * num_instances; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "%d", page_id_temp);
+  }
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(buffer_pool_size * num_instances); ++page_id) {
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(buffer_pool_size * num_instances); ++page_id) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(page_id, std::stoi(page->GetData()));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+  // There is nothing remote on a machine with a single node.
+  if (num_nodes == 1) {
+    EXPECT_EQ(0, bpm->GetRemoteAccessCount());
+  }
+  enable_numa_local_allocation = numa_local;
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  RemoveFreePageMaps(num_instances);
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, StatsTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 2;
+  const size_t num_instances = 3;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager);
+
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < buffer_pool_size * num_instances * 2; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_TRUE(bpm->UnpinPage(page_id_temp, false));
+  }
+
+  // Scenario: the statistics of all instances add up. Each instance still holds the last half of its pages.
+  for (auto page_id = static_cast<page_id_t>(buffer_pool_size * num_instances * 2) - 1; page_id >= 0; --page_id) {
+    ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+  auto stats = bpm->GetStats();
+  EXPECT_EQ(buffer_pool_size * num_instances * 2, stats.hits_ + stats.misses_);
+  EXPECT_EQ(buffer_pool_size * num_instances, stats.misses_);
+  EXPECT_EQ(buffer_pool_size * num_instances * 2, stats.evictions_);
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  RemoveFreePageMaps(num_instances);
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, OccupancyTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 4;
+  const size_t num_instances = 3;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager);
+
+  // Scenario: new pages spread evenly, and once every frame is pinned nothing is tried at all.
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < buffer_pool_size * num_instances; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(static_cast<page_id_t>(i), page_id_temp);
+  }
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_EQ(0, bpm->GetStats().pin_waits_);
+
+  // Scenario: instance 0 stays full of pinned pages and instance 2 has one frame left, so instance 1 takes new pages
+  // until it is as occupied as instance 2. No attempt goes to instance 0.
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(buffer_pool_size * num_instances); ++page_id) {
+    if (page_id % num_instances == 1 || page_id == 2) {
+      EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+    }
+  }
+  for (size_t i = 0; i < buffer_pool_size - 1; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(1, page_id_temp % num_instances);
+  }
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_EQ(0, bpm->GetStats().pin_waits_);
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  RemoveFreePageMaps(num_instances);
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, FlushAllTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 4;
+  const size_t num_instances = 3;
+  // Keep the background writer out of the way, so that every dirty page is left to the flush.
+  const size_t bg_writer_max_pages = background_writer_max_pages;
+  background_writer_max_pages = 0;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager);
+
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < buffer_pool_size * num_instances; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_TRUE(bpm->UnpinPage(page_id_temp, false));
+  }
+  // Dirty a run of pages spread over all instances, and a few pages apart from it.
+  const std::vector<page_id_t> dirty_page_ids{9, 3, 4, 11, 5, 0};
+  for (auto page_id : dirty_page_ids) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id);
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+
+  // Scenario: only the dirty pages of all instances are written, and only once.
+  const int num_writes = disk_manager->GetNumWrites();
+  bpm->FlushAllPages();
+  EXPECT_EQ(num_writes + static_cast<int>(dirty_page_ids.size()), disk_manager->GetNumWrites());
+  bpm->FlushAllPages();
+  EXPECT_EQ(num_writes + static_cast<int>(dirty_page_ids.size()), disk_manager->GetNumWrites());
+  char data[PAGE_SIZE];
+  char expected[PAGE_SIZE];
+  for (auto page_id : dirty_page_ids) {
+    disk_manager->ReadPage(page_id, data);
+    snprintf(expected, PAGE_SIZE, "page %d", page_id);
+    EXPECT_STREQ(expected, data);
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  RemoveFreePageMaps(num_instances);
 
   delete bpm;
   delete disk_manager;
+  background_writer_max_pages = bg_writer_max_pages;
 }
 
 }  // namespace bustub
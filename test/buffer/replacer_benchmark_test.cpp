@@ -0,0 +1,192 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// replacer_benchmark_test.cpp
+//
+// Identification: test/buffer/replacer_benchmark_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <chrono>  // NOLINT
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "buffer/arc_replacer.h"
+#include "buffer/clock_replacer.h"
+#include "buffer/lru_k_replacer.h"
+#include "buffer/lru_replacer.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+/** Number of frames the traces are replayed against. */
+static constexpr size_t NUM_FRAMES = 256;
+/** Number of page accesses in every generated trace. */
+static constexpr size_t TRACE_LENGTH = 200000;
+
+/** @return a new replacer of the given policy for NUM_FRAMES frames */
+static std::unique_ptr<Replacer> MakeReplacer(ReplacerType replacer_type) {
+  switch (replacer_type) {
+    case ReplacerType::LRU_K:
+      return std::make_unique<LRUKReplacer>(NUM_FRAMES);
+    case ReplacerType::CLOCK:
+      return std::make_unique<ClockReplacer>(NUM_FRAMES);
+    case ReplacerType::ARC:
+      return std::make_unique<ARCReplacer>(NUM_FRAMES);
+    case ReplacerType::LRU:
+    default:
+      return std::make_unique<LRUReplacer>(NUM_FRAMES);
+  }
+}
+
+/**
+ * Replays a page access trace against a replacer the way a buffer pool drives it: a hit pins and unpins the frame of
+ * the page, a miss takes a free frame or a victim, loads the page into it and pins and unpins it.
+ * @return the hit rate
+ */
+static double ReplayTrace(Replacer *replacer, const std::vector<page_id_t> &trace) {
+  std::unordered_map<page_id_t, frame_id_t> page_table;
+  std::vector<page_id_t> frames(NUM_FRAMES, INVALID_PAGE_ID);
+  size_t num_used_frames = 0;
+  size_t hits = 0;
+  for (page_id_t page_id : trace) {
+    auto it = page_table.find(page_id);
+    if (it != page_table.end()) {
+      hits++;
+      replacer->Pin(it->second);
+      replacer->Unpin(it->second);
+      continue;
+    }
+    frame_id_t frame_id;
+    if (num_used_frames < NUM_FRAMES) {
+      frame_id = static_cast<frame_id_t>(num_used_frames++);
+    } else {
+      EXPECT_TRUE(replacer->Victim(&frame_id));
+      page_table.erase(frames[frame_id]);
+    }
+    frames[frame_id] = page_id;
+    page_table.emplace(page_id, frame_id);
+    replacer->AssignPage(frame_id, page_id);
+    replacer->Pin(frame_id);
+    replacer->Unpin(frame_id);
+  }
+  return trace.empty() ? 0 : static_cast<double>(hits) / static_cast<double>(trace.size());
+}
+
+/** Appends count accesses to pages [begin, begin + num_pages), skewed towards the low ids by a Zipf distribution. */
+static void AppendZipf(std::vector<page_id_t> *trace, page_id_t begin, size_t num_pages, size_t count,
+                       std::mt19937 *rng) {
+  std::vector<double> weights(num_pages);
+  for (size_t i = 0; i < num_pages; ++i) {
+    weights[i] = 1.0 / std::pow(static_cast<double>(i + 1), 0.9);
+  }
+  std::discrete_distribution<size_t> dist(weights.begin(), weights.end());
+  for (size_t i = 0; i < count; ++i) {
+    trace->push_back(begin + static_cast<page_id_t>(dist(*rng)));
+  }
+}
+
+/** Appends count accesses that loop over pages [begin, begin + num_pages). */
+static void AppendLoop(std::vector<page_id_t> *trace, page_id_t begin, size_t num_pages, size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    trace->push_back(begin + static_cast<page_id_t>(i % num_pages));
+  }
+}
+
+/** @return the traces the policies are compared on, by name */
+static std::vector<std::pair<std::string, std::vector<page_id_t>>> MakeTraces() {
+  std::mt19937 rng(15445);
+  std::vector<std::pair<std::string, std::vector<page_id_t>>> traces;
+
+  // Skewed point lookups over a table four times the size of the pool.
+  std::vector<page_id_t> zipf;
+  AppendZipf(&zipf, 0, 4 * NUM_FRAMES, TRACE_LENGTH, &rng);
+  traces.emplace_back("zipf", std::move(zipf));
+
+  // A loop slightly larger than the pool, the worst case of LRU.
+  std::vector<page_id_t> loop;
+  AppendLoop(&loop, 0, NUM_FRAMES + NUM_FRAMES / 4, TRACE_LENGTH);
+  traces.emplace_back("loop", std::move(loop));
+
+  // Lookups on a hot set half the size of the pool, interleaved with a scan over a large table.
+  std::vector<page_id_t> scan;
+  std::uniform_int_distribution<page_id_t> hot_dist(0, NUM_FRAMES / 2 - 1);
+  for (size_t i = 0; scan.size() < TRACE_LENGTH; ++i) {
+    scan.push_back(hot_dist(rng));
+    scan.push_back(static_cast<page_id_t>(NUM_FRAMES + i % (64 * NUM_FRAMES)));
+  }
+  traces.emplace_back("scan+hot", std::move(scan));
+
+  // Phases that alternate between frequency, skewed lookups, and recency, a working set that slides along a table.
+  std::vector<page_id_t> shifting;
+  const size_t phase_length = TRACE_LENGTH / 8;
+  for (size_t phase = 0; shifting.size() < TRACE_LENGTH; ++phase) {
+    if (phase % 2 == 0) {
+      AppendZipf(&shifting, 0, 4 * NUM_FRAMES, phase_length, &rng);
+      continue;
+    }
+    const auto base = static_cast<page_id_t>(8 * NUM_FRAMES + phase * NUM_FRAMES);
+    std::uniform_int_distribution<page_id_t> window_dist(0, NUM_FRAMES / 2 - 1);
+    for (size_t i = 0; i < phase_length; ++i) {
+      shifting.push_back(base + static_cast<page_id_t>(i / 64) + window_dist(rng));
+    }
+  }
+  traces.emplace_back("shifting", std::move(shifting));
+
+  // A trace of whitespace separated page ids, e.g. recorded from a real workload, replayed on top of the above.
+  const char *trace_file = std::getenv("BUSTUB_REPLACER_TRACE");
+  if (trace_file != nullptr) {
+    std::ifstream in(trace_file);
+    std::vector<page_id_t> recorded;
+    page_id_t page_id;
+    while (in >> page_id) {
+      recorded.push_back(page_id);
+    }
+    traces.emplace_back(trace_file, std::move(recorded));
+  }
+  return traces;
+}
+
+// NOLINTNEXTLINE
+TEST(ReplacerBenchmarkTest, TraceReplayBenchmark) {
+  const std::vector<std::pair<std::string, ReplacerType>> policies{{"LRU", ReplacerType::LRU},
+                                                                   {"LRU-K", ReplacerType::LRU_K},
+                                                                   {"Clock", ReplacerType::CLOCK},
+                                                                   {"ARC", ReplacerType::ARC}};
+  std::unordered_map<std::string, std::unordered_map<std::string, double>> hit_rates;
+  std::cout << std::fixed << std::setprecision(3);
+  for (const auto &[trace_name, trace] : MakeTraces()) {
+    std::cout << trace_name << " (" << trace.size() << " accesses, " << NUM_FRAMES << " frames):";
+    for (const auto &[policy_name, replacer_type] : policies) {
+      auto replacer = MakeReplacer(replacer_type);
+      const auto start = std::chrono::steady_clock::now();
+      const double hit_rate = ReplayTrace(replacer.get(), trace);
+      const auto elapsed =
+          std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+      hit_rates[trace_name][policy_name] = hit_rate;
+      std::cout << " " << policy_name << " " << hit_rate << " (" << elapsed.count() << " ms)";
+    }
+    std::cout << std::endl;
+  }
+
+  // A scan never pushes the hot set out of ARC, and it follows the shifting trace where LRU-K stays stuck in the past.
+  EXPECT_GT(hit_rates["scan+hot"]["ARC"], hit_rates["scan+hot"]["LRU"] + 0.1);
+  EXPECT_GT(hit_rates["shifting"]["ARC"], hit_rates["shifting"]["LRU-K"] + 0.1);
+  EXPECT_GE(hit_rates["shifting"]["ARC"], hit_rates["shifting"]["LRU"] - 0.01);
+  EXPECT_GE(hit_rates["zipf"]["ARC"], hit_rates["zipf"]["LRU"] - 0.01);
+}
+
+}  // namespace bustub
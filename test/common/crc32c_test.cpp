@@ -0,0 +1,55 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// crc32c_test.cpp
+//
+// Identification: test/common/crc32c_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <random>
+#include <vector>
+
+#include "common/util/crc32c.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+/** @return the CRC-32C of the bytes, computed a bit at a time */
+static uint32_t BitwiseCrc32c(const char *data, size_t size) {
+  uint32_t crc = ~uint32_t{0};
+  for (size_t i = 0; i < size; ++i) {
+    crc ^= static_cast<uint8_t>(data[i]);
+    for (int bit = 0; bit < 8; ++bit) {
+      crc = (crc >> 1) ^ ((crc & 1) != 0 ? 0x82F63B78 : 0);
+    }
+  }
+  return ~crc;
+}
+
+// NOLINTNEXTLINE
+TEST(Crc32cTest, KnownValueTest) {
+  EXPECT_EQ(0xE3069283, Crc32c::Compute("123456789", 9));
+  EXPECT_EQ(0U, Crc32c::Compute("", 0));
+}
+
+// NOLINTNEXTLINE
+TEST(Crc32cTest, MatchesBitwiseTest) {
+  std::mt19937 rng(15445);
+  std::vector<char> data(20000);
+  for (auto &byte : data) {
+    byte = static_cast<char>(rng());
+  }
+  // Sizes around a page and the streams it is split into, at unaligned starts too.
+  for (size_t size : {1, 7, 8, 100, 4079, 4080, 4081, 4096, 8160, 12288, 16384}) {
+    for (size_t start : {0, 1, 3}) {
+      EXPECT_EQ(BitwiseCrc32c(data.data() + start, size), Crc32c::Compute(data.data() + start, size))
+          << "size " << size << " start " << start;
+    }
+  }
+}
+
+}  // namespace bustub
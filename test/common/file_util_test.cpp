@@ -0,0 +1,50 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// file_util_test.cpp
+//
+// Identification: test/common/file_util_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "common/util/file_util.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+/** @return the contents of a file */
+static std::string ReadFile(const std::string &file_name) {
+  std::ifstream in(file_name, std::ios::binary);
+  std::stringstream contents;
+  contents << in.rdbuf();
+  return contents.str();
+}
+
+// NOLINTNEXTLINE
+TEST(FileUtilTest, ReplaceFileTest) {
+  const std::string file_name = "file_util_test.dat";
+  remove(file_name.c_str());
+
+  // Scenario: the file is created, and replaced by shorter contents later.
+  EXPECT_TRUE(FileUtil::ReplaceFile(file_name, std::string("first\0contents", 14)));
+  EXPECT_EQ(std::string("first\0contents", 14), ReadFile(file_name));
+  EXPECT_TRUE(FileUtil::ReplaceFile(file_name, "second"));
+  EXPECT_EQ("second", ReadFile(file_name));
+  // the temporary file is gone
+  EXPECT_FALSE(std::ifstream(file_name + ".tmp").good());
+
+  // Scenario: a file in a directory that does not exist cannot be written.
+  EXPECT_FALSE(FileUtil::ReplaceFile("file_util_test_missing/file.dat", "data"));
+
+  remove(file_name.c_str());
+}
+
+}  // namespace bustub
@@ -75,6 +75,7 @@ class ExecutorTest : public ::testing::Test {
     disk_manager_->ShutDown();
     remove("executor_test.db");
     remove("executor_test.log");
+    remove("executor_test.fsm0");
     delete txn_;
   };
 
@@ -0,0 +1,267 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// log_manager_test.cpp
+//
+// Identification: test/recovery/log_manager_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "catalog/schema.h"
+#include "common/config.h"
+#include "concurrency/lock_manager.h"
+#include "concurrency/transaction_manager.h"
+#include "gtest/gtest.h"
+#include "recovery/log_manager.h"
+#include "storage/table/table_heap.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+/** Size of a log record header, see log_record.h. */
+static constexpr int HEADER_SIZE = 20;
+/** Size of a NEWPAGE record. */
+static constexpr int NEWPAGE_SIZE = HEADER_SIZE + 2 * static_cast<int>(sizeof(page_id_t));
+
+class LogManagerTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    remove("test.db");
+    remove("test.log");
+  }
+
+  void TearDown() override {
+    remove("test.db");
+    remove("test.log");
+  }
+};
+
+// NOLINTNEXTLINE
+TEST_F(LogManagerTest, ConcurrentAppendTest) {
+  constexpr int num_threads = 8;
+  constexpr int num_records = 2000;
+  DiskManager disk_manager("test.db");
+  LogManager log_manager(&disk_manager);
+
+  // Records of two sizes, several buffers full of them, so that buffers fill up while others append.
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; ++tid) {
+    threads.emplace_back([&, tid] {
+      lsn_t prev_lsn = INVALID_LSN;
+      for (int i = 0; i < num_records; ++i) {
+        LogRecord log_record = i % 2 == 0 ? LogRecord(tid, prev_lsn, LogRecordType::BEGIN)
+                                          : LogRecord(tid, prev_lsn, LogRecordType::NEWPAGE, i - 1, i);
+        const lsn_t lsn = log_manager.AppendLogRecord(&log_record);
+        EXPECT_EQ(lsn, log_record.GetLSN());
+        EXPECT_GT(lsn, prev_lsn);
+        prev_lsn = lsn;
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  constexpr int total = num_threads * num_records;
+  EXPECT_EQ(total, log_manager.GetNextLSN());
+  log_manager.Flush();
+  EXPECT_EQ(total - 1, log_manager.GetPersistentLSN());
+  EXPECT_GT(disk_manager.GetNumFlushes(), 2);
+
+  // The log holds every record once, in LSN order.
+  constexpr int log_size = total / 2 * (HEADER_SIZE + NEWPAGE_SIZE);
+  std::vector<char> log(log_size);
+  ASSERT_TRUE(disk_manager.ReadLog(log.data(), log_size, 0));
+  std::vector<lsn_t> prev_lsns(num_threads, INVALID_LSN);
+  int offset = 0;
+  for (lsn_t lsn = 0; lsn < total; ++lsn) {
+    ASSERT_LT(offset, log_size);
+    int32_t size;
+    lsn_t record_lsn;
+    txn_id_t txn_id;
+    lsn_t prev_lsn;
+    LogRecordType type;
+    memcpy(&size, log.data() + offset, sizeof(int32_t));
+    memcpy(&record_lsn, log.data() + offset + 4, sizeof(lsn_t));
+    memcpy(&txn_id, log.data() + offset + 8, sizeof(txn_id_t));
+    memcpy(&prev_lsn, log.data() + offset + 12, sizeof(lsn_t));
+    memcpy(&type, log.data() + offset + 16, sizeof(LogRecordType));
+    ASSERT_EQ(lsn, record_lsn);
+    ASSERT_TRUE(txn_id >= 0 && txn_id < num_threads);
+    EXPECT_EQ(prev_lsns[txn_id], prev_lsn);
+    prev_lsns[txn_id] = lsn;
+    if (type == LogRecordType::NEWPAGE) {
+      EXPECT_EQ(NEWPAGE_SIZE, size);
+    } else {
+      EXPECT_EQ(LogRecordType::BEGIN, type);
+      EXPECT_EQ(HEADER_SIZE, size);
+    }
+    offset += size;
+  }
+  EXPECT_EQ(log_size, offset);
+  disk_manager.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(LogManagerTest, GroupCommitTest) {
+  constexpr int num_threads = 8;
+  constexpr int num_txns = 50;
+  DiskManager disk_manager("test.db");
+  LogManager log_manager(&disk_manager);
+  LockManager lock_manager;
+  TransactionManager txn_manager(&lock_manager, &log_manager);
+  log_manager.RunFlushThread();
+
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; ++tid) {
+    threads.emplace_back([&] {
+      for (int i = 0; i < num_txns; ++i) {
+        Transaction *txn = txn_manager.Begin();
+        txn_manager.Commit(txn);
+        // Commit returns once the commit record is durable.
+        EXPECT_GE(log_manager.GetPersistentLSN(), txn->GetPrevLSN());
+        delete txn;
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  log_manager.StopFlushThread();
+  EXPECT_FALSE(enable_logging);
+
+  // Commits waiting together are made durable by a single write and sync.
+  const int num_flushes = disk_manager.GetNumFlushes();
+  std::cout << num_threads * num_txns << " commits, " << num_flushes << " log flushes" << std::endl;
+  EXPECT_LT(num_flushes, num_threads * num_txns);
+  disk_manager.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(LogManagerTest, AsyncCommitTest) {
+  constexpr int num_threads = 8;
+  constexpr int num_txns = 200;
+  DiskManager disk_manager("test.db");
+  LogManager log_manager(&disk_manager);
+  LockManager lock_manager;
+  TransactionManager txn_manager(&lock_manager, &log_manager);
+  txn_manager.SetAsyncCommit(true);
+  log_manager.RunFlushThread();
+
+  std::vector<std::thread> threads;
+  std::atomic<lsn_t> last_lsn{INVALID_LSN};
+  for (int tid = 0; tid < num_threads; ++tid) {
+    threads.emplace_back([&] {
+      for (int i = 0; i < num_txns; ++i) {
+        Transaction *txn = txn_manager.Begin();
+        txn_manager.Commit(txn);
+        lsn_t lsn = last_lsn;
+        while (txn->GetPrevLSN() > lsn && !last_lsn.compare_exchange_weak(lsn, txn->GetPrevLSN())) {
+        }
+        delete txn;
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  // The commits did not wait for the log, the flush thread writes it within the lag, well before log_timeout.
+  const auto timeout = std::chrono::milliseconds(500);
+  ASSERT_LT(timeout, log_timeout);
+  const auto start = std::chrono::steady_clock::now();
+  while (log_manager.GetPersistentLSN() < last_lsn && std::chrono::steady_clock::now() - start < timeout) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  EXPECT_EQ(last_lsn, log_manager.GetPersistentLSN());
+  const int num_flushes = disk_manager.GetNumFlushes();
+  std::cout << num_threads * num_txns << " asynchronous commits, " << num_flushes << " log flushes" << std::endl;
+  EXPECT_LT(num_flushes, num_threads * num_txns / 10);
+  log_manager.StopFlushThread();
+  disk_manager.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(LogManagerTest, AsyncCommitMaxLagBytesTest) {
+  constexpr size_t max_lag_bytes = 1000;
+  const auto max_lag = async_commit_max_lag;
+  const auto max_bytes = async_commit_max_lag_bytes.load();
+  async_commit_max_lag = std::chrono::minutes(1);
+  async_commit_max_lag_bytes = max_lag_bytes;
+  DiskManager disk_manager("test.db");
+  LogManager log_manager(&disk_manager);
+  LockManager lock_manager;
+  TransactionManager txn_manager(&lock_manager, &log_manager);
+  log_manager.RunFlushThread();
+
+  // Only the log past the bound is waited for.
+  for (int i = 0; i < 200; ++i) {
+    Transaction *txn = txn_manager.Begin();
+    txn->SetAsyncCommit(true);
+    txn_manager.Commit(txn);
+    EXPECT_LE(log_manager.GetLagBytes(), max_lag_bytes);
+    delete txn;
+  }
+  EXPECT_GT(disk_manager.GetNumFlushes(), 0);
+  EXPECT_LT(disk_manager.GetNumFlushes(), 200);
+
+  // Committing synchronously still waits.
+  Transaction *txn = txn_manager.Begin();
+  txn_manager.Commit(txn);
+  EXPECT_EQ(txn->GetPrevLSN(), log_manager.GetPersistentLSN());
+  delete txn;
+  log_manager.StopFlushThread();
+  disk_manager.ShutDown();
+  async_commit_max_lag = max_lag;
+  async_commit_max_lag_bytes = max_bytes;
+}
+
+// NOLINTNEXTLINE
+TEST_F(LogManagerTest, AsyncCommitWriteAheadTest) {
+  const auto timeout = log_timeout;
+  const auto max_lag = async_commit_max_lag;
+  log_timeout = std::chrono::minutes(1);
+  async_commit_max_lag = std::chrono::minutes(1);
+  DiskManager disk_manager("test.db");
+  LogManager log_manager(&disk_manager);
+  BufferPoolManagerInstance bpm(4, &disk_manager, &log_manager);
+  LockManager lock_manager;
+  TransactionManager txn_manager(&lock_manager, &log_manager);
+  log_manager.RunFlushThread();
+
+  // An asynchronous commit returns before its records are durable.
+  Schema schema({Column("a", TypeId::INTEGER)});
+  Transaction *txn = txn_manager.Begin();
+  txn->SetAsyncCommit(true);
+  TableHeap table(&bpm, &lock_manager, &log_manager, txn);
+  RID rid;
+  ASSERT_TRUE(table.InsertTuple(Tuple({ValueFactory::GetIntegerValue(1)}, &schema), &rid, txn));
+  txn_manager.Commit(txn);
+  EXPECT_LT(log_manager.GetPersistentLSN(), txn->GetPrevLSN());
+  Page *page = bpm.FetchPage(rid.GetPageId());
+  ASSERT_NE(nullptr, page);
+  const lsn_t page_lsn = page->GetLSN();
+  EXPECT_TRUE(bpm.UnpinPage(rid.GetPageId(), false));
+  EXPECT_LT(log_manager.GetPersistentLSN(), page_lsn);
+
+  // Its pages still only reach the disk after the records that changed them.
+  bpm.FlushAllPages();
+  EXPECT_LE(page_lsn, log_manager.GetPersistentLSN());
+  delete txn;
+  log_manager.StopFlushThread();
+  disk_manager.ShutDown();
+  remove("test.fsm0");
+  log_timeout = timeout;
+  async_commit_max_lag = max_lag;
+}
+
+}  // namespace bustub
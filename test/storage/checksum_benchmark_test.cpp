@@ -0,0 +1,134 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// checksum_benchmark_test.cpp
+//
+// Identification: test/storage/checksum_benchmark_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "common/config.h"
+#include "common/util/crc32c.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+/** Number of pages written and read back by every round. */
+static constexpr size_t NUM_PAGES = 2048;
+/** Number of rounds, the fastest one counts. */
+static constexpr size_t NUM_ROUNDS = 3;
+/** Number of pages the checksum alone is timed on, few enough to stay in the CPU caches. */
+static constexpr size_t CACHED_PAGES = 16;
+
+/** Time of the I/O of one round, in nanoseconds per page. */
+struct IoTimes {
+  double write_ns_{0};
+  double read_ns_{0};
+};
+
+/** @return nanoseconds elapsed since start, per page */
+static double NanosPerPage(std::chrono::steady_clock::time_point start) {
+  const auto elapsed = std::chrono::steady_clock::now() - start;
+  return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()) / NUM_PAGES;
+}
+
+/**
+ * Writes NUM_PAGES pages in one batch, which ends with a sync, then reads them back one by one in random order, the
+ * way a buffer pool misses. The database bypasses the OS page cache where it can, so the reads hit the disk.
+ */
+static IoTimes MeasureIo(bool checksums, char *pages) {
+  remove("checksum_bench.db");
+  enable_page_checksums = checksums;
+  IoTimes times;
+  {
+    DiskManager dm("checksum_bench.db", true);
+    std::vector<page_id_t> page_ids(NUM_PAGES);
+    std::vector<const char *> page_data(NUM_PAGES);
+    for (size_t i = 0; i < NUM_PAGES; ++i) {
+      page_ids[i] = static_cast<page_id_t>(i);
+      page_data[i] = pages + i * PAGE_SIZE;
+    }
+    // A first write allocates the file and the disk manager's bounce pages, the way a long running database has them.
+    dm.WritePages(page_ids, page_data.data());
+    auto start = std::chrono::steady_clock::now();
+    dm.WritePages(page_ids, page_data.data());
+    times.write_ns_ = NanosPerPage(start);
+
+    std::shuffle(page_ids.begin(), page_ids.end(), std::mt19937(15445));
+    auto *buf = static_cast<char *>(std::aligned_alloc(PAGE_SIZE, PAGE_SIZE));
+    start = std::chrono::steady_clock::now();
+    for (page_id_t page_id : page_ids) {
+      dm.ReadPage(page_id, buf);
+    }
+    times.read_ns_ = NanosPerPage(start);
+    std::free(buf);
+    dm.ShutDown();
+  }
+  enable_page_checksums = true;
+  remove("checksum_bench.db");
+  remove("checksum_bench.log");
+  return times;
+}
+
+// A benchmark rather than a test, its timings depend on the machine and the disk. Run it with
+// --gtest_also_run_disabled_tests.
+// NOLINTNEXTLINE
+TEST(ChecksumBenchmarkTest, DISABLED_ChecksumOverheadBenchmark) {
+  auto *pages = static_cast<char *>(std::aligned_alloc(PAGE_SIZE, NUM_PAGES * PAGE_SIZE));
+  std::mt19937 rng(15445);
+  for (size_t i = 0; i < NUM_PAGES * PAGE_SIZE; ++i) {
+    pages[i] = static_cast<char>(rng());
+  }
+
+  // The checksum alone. A page is verified right after it is read, so it is computed over pages in the CPU caches.
+  uint32_t sink = 0;
+  const auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < NUM_ROUNDS * NUM_PAGES; ++i) {
+    sink += Crc32c::Compute(pages + i % CACHED_PAGES * PAGE_SIZE, PAGE_CHECKSUM_OFFSET);
+  }
+  const double crc_ns = NanosPerPage(start) / NUM_ROUNDS;
+  EXPECT_NE(0U, sink);
+
+  IoTimes off{1e18, 1e18};
+  IoTimes on{1e18, 1e18};
+  for (size_t round = 0; round < NUM_ROUNDS; ++round) {
+    const IoTimes round_off = MeasureIo(false, pages);
+    const IoTimes round_on = MeasureIo(true, pages);
+    off = {std::min(off.write_ns_, round_off.write_ns_), std::min(off.read_ns_, round_off.read_ns_)};
+    on = {std::min(on.write_ns_, round_on.write_ns_), std::min(on.read_ns_, round_on.read_ns_)};
+  }
+  bool direct_io;
+  {
+    DiskManager dm("checksum_bench.db", true);
+    direct_io = dm.IsDirectIo();
+    dm.ShutDown();
+  }
+  remove("checksum_bench.db");
+  remove("checksum_bench.log");
+  std::free(pages);
+
+  std::cout << std::fixed << std::setprecision(1);
+  std::cout << "CRC32C (" << (Crc32c::IsHardwareAccelerated() ? "hardware" : "table") << "): " << crc_ns
+            << " ns per page, " << PAGE_SIZE / crc_ns << " GB/s" << std::endl;
+  std::cout << "page I/O" << (direct_io ? " (O_DIRECT)" : " (buffered)") << ", ns per page: write " << off.write_ns_
+            << " -> " << on.write_ns_ << ", read " << off.read_ns_ << " -> " << on.read_ns_ << " with checksums"
+            << std::endl;
+  std::cout << "checksum share of the read time: " << 100 * crc_ns / off.read_ns_ << "%, write overhead: "
+            << 100 * (on.write_ns_ - off.write_ns_) / off.write_ns_ << "%" << std::endl;
+}
+
+}  // namespace bustub
@@ -10,7 +10,14 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cstdlib>
 #include <cstring>
+#include <future>  // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
 
 #include "common/exception.h"
 #include "gtest/gtest.h"
@@ -30,7 +37,14 @@ class DiskManagerTest : public ::testing::Test {
   void TearDown() override {
     remove("test.db");
     remove("test.log");
+    remove("test.tsp");
+    for (const auto &data_file : data_files_) {
+      remove(data_file.c_str());
+    }
   };
+
+  // data files of striped tests
+  const std::vector<std::string> data_files_{"test_0.db", "test_1.db", "test_2.db"};
 };
 
 // NOLINTNEXTLINE
@@ -45,14 +59,362 @@ TEST_F(DiskManagerTest, ReadWritePageTest) {
 
   dm.WritePage(0, data);
   dm.ReadPage(0, buf);
-  EXPECT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+  EXPECT_EQ(std::memcmp(buf, data, PAGE_CHECKSUM_OFFSET), 0);
+  // The checksum goes to disk only, the page written is left as it was.
+  EXPECT_EQ('\0', data[PAGE_CHECKSUM_OFFSET]);
+  EXPECT_NE(0, std::memcmp(buf + PAGE_CHECKSUM_OFFSET, data + PAGE_CHECKSUM_OFFSET, PAGE_SIZE - PAGE_CHECKSUM_OFFSET));
 
   std::memset(buf, 0, sizeof(buf));
   dm.WritePage(5, data);
   dm.ReadPage(5, buf);
-  EXPECT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+  EXPECT_EQ(std::memcmp(buf, data, PAGE_CHECKSUM_OFFSET), 0);
+
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, ConcurrentReadWritePageTest) {
+  const int num_threads = 4;
+  const int pages_per_thread = 50;
+  std::string db_file("test.db");
+  auto dm = DiskManager(db_file);
+
+  // Every thread writes and reads back its own pages, interleaved with the pages of the others.
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; ++tid) {
+    threads.emplace_back([&dm, tid] {
+      char buf[PAGE_SIZE];
+      char data[PAGE_SIZE];
+      for (int i = 0; i < pages_per_thread; ++i) {
+        page_id_t page_id = i * num_threads + tid;
+        std::memset(data, 'a' + tid, sizeof(data));
+        std::snprintf(data, sizeof(data), "page %d", page_id);
+        dm.WritePage(page_id, data);
+        dm.ReadPage(page_id, buf);
+        EXPECT_EQ(std::memcmp(buf, data, PAGE_CHECKSUM_OFFSET), 0);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(num_threads * pages_per_thread, dm.GetNumWrites());
+  EXPECT_EQ(0, dm.GetNumSyncs());
+
+  // A batch of pages goes out with one sync, and reads back in runs past the end of the file.
+  char data[3][PAGE_SIZE];
+  for (int i = 0; i < 3; ++i) {
+    std::memset(data[i], 'x' + i, PAGE_SIZE);
+  }
+  const page_id_t last_page_id = num_threads * pages_per_thread;
+  const char *write_data[] = {data[0], data[1], data[2]};
+  dm.WritePages({3, 4, last_page_id}, write_data);
+  EXPECT_EQ(1, dm.GetNumSyncs());
+  char buf[3][PAGE_SIZE];
+  char *read_data[] = {buf[0], buf[1], buf[2]};
+  dm.ReadPages({3, 4, last_page_id}, read_data);
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(std::memcmp(buf[i], data[i], PAGE_CHECKSUM_OFFSET), 0);
+  }
+  dm.ReadPages({last_page_id, last_page_id + 1}, read_data);
+  EXPECT_EQ(std::memcmp(buf[0], data[2], PAGE_CHECKSUM_OFFSET), 0);
+  EXPECT_EQ('\0', buf[1][0]);
+  EXPECT_EQ('\0', buf[1][PAGE_SIZE - 1]);
+
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, AsyncReadWritePageTest) {
+  const size_t queue_depth = async_io_queue_depth;
+  async_io_queue_depth = 4;
+  // Scenario: io_uring first, then the fallback pool of pread/pwrite workers.
+  bool io_uring_ran = false;
+  for (bool use_io_uring : {true, false}) {
+    enable_io_uring = use_io_uring;
+    std::string db_file("test.db");
+    auto dm = DiskManager(db_file);
+
+    // Keep more pages in flight than the queue takes at once.
+    const int num_pages = 32;
+    std::vector<std::vector<char>> data(num_pages, std::vector<char>(PAGE_SIZE));
+    std::vector<std::future<void>> writes;
+    for (int i = 0; i < num_pages; ++i) {
+      std::memset(data[i].data(), 'a' + i % 26, PAGE_SIZE);
+      std::snprintf(data[i].data(), PAGE_SIZE, "page %d", i);
+      writes.push_back(dm.WritePageAsync(i, data[i].data()));
+    }
+    for (auto &write : writes) {
+      write.wait();
+    }
+    EXPECT_EQ(num_pages, dm.GetNumWrites());
+    if (use_io_uring) {
+      io_uring_ran = dm.UsesIoUring();
+    } else {
+      EXPECT_FALSE(dm.UsesIoUring());
+    }
+
+    std::vector<std::vector<char>> buf(num_pages + 1, std::vector<char>(PAGE_SIZE, 'z'));
+    std::vector<std::future<void>> reads;
+    for (int i = num_pages; i >= 0; --i) {
+      reads.push_back(dm.ReadPageAsync(i, buf[i].data()));
+    }
+    for (auto &read : reads) {
+      read.wait();
+    }
+    for (int i = 0; i < num_pages; ++i) {
+      EXPECT_EQ(std::memcmp(buf[i].data(), data[i].data(), PAGE_CHECKSUM_OFFSET), 0);
+    }
+    // Past the end of the file the page reads as zeroes.
+    EXPECT_EQ('\0', buf[num_pages][0]);
+    EXPECT_EQ('\0', buf[num_pages][PAGE_SIZE - 1]);
+
+    dm.ShutDown();
+    // The backend is gone with the files, a late request fails instead of touching either.
+    EXPECT_THROW(dm.ReadPageAsync(0, buf[0].data()), Exception);
+    remove("test.db");
+  }
+  enable_io_uring = true;
+  async_io_queue_depth = queue_depth;
+  if (!io_uring_ran) {
+    GTEST_SKIP() << "io_uring is not available, only the worker threads ran";
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, LargeFileTest) {
+  std::string db_file("test.db");
+  auto dm = DiskManager(db_file);
+
+  // Pages around the 2 GB and 4 GB boundaries, the file stays sparse in between.
+  const int64_t two_gb = int64_t{1} << 31;
+  const int64_t four_gb = int64_t{1} << 32;
+  const std::vector<page_id_t> page_ids{static_cast<page_id_t>(two_gb / PAGE_SIZE - 1),
+                                        static_cast<page_id_t>(two_gb / PAGE_SIZE),
+                                        static_cast<page_id_t>(four_gb / PAGE_SIZE - 1),
+                                        static_cast<page_id_t>(four_gb / PAGE_SIZE)};
+  char data[PAGE_SIZE];
+  char buf[PAGE_SIZE];
+  for (auto page_id : page_ids) {
+    std::memset(data, 0, sizeof(data));
+    std::snprintf(data, sizeof(data), "page %d", page_id);
+    dm.WritePage(page_id, data);
+  }
+  EXPECT_EQ(four_gb + PAGE_SIZE, dm.GetFileSize(db_file));
+
+  for (auto page_id : page_ids) {
+    std::snprintf(data, sizeof(data), "page %d", page_id);
+    dm.ReadPage(page_id, buf);
+    EXPECT_STREQ(data, buf);
+    std::memset(buf, 0, sizeof(buf));
+    dm.ReadPageAsync(page_id, buf).wait();
+    EXPECT_STREQ(data, buf);
+  }
+  // A batch crossing the 4 GB boundary, and the page past the end of the file.
+  char batch[3][PAGE_SIZE];
+  char *batch_data[] = {batch[0], batch[1], batch[2]};
+  std::memset(batch, 'x', sizeof(batch));
+  dm.ReadPages({page_ids[2], page_ids[3], page_ids[3] + 1}, batch_data);
+  std::snprintf(data, sizeof(data), "page %d", page_ids[2]);
+  EXPECT_STREQ(data, batch[0]);
+  std::snprintf(data, sizeof(data), "page %d", page_ids[3]);
+  EXPECT_STREQ(data, batch[1]);
+  EXPECT_EQ('\0', batch[2][0]);
+
+  // A log record beyond 4 GB.
+  char log_data[16] = "A log record.";
+  char log_buf[16] = {0};
+  ASSERT_EQ(0, truncate("test.log", four_gb + 1));
+  dm.WriteLog(log_data, sizeof(log_data));
+  EXPECT_TRUE(dm.ReadLog(log_buf, sizeof(log_buf), four_gb + 1));
+  EXPECT_STREQ(log_data, log_buf);
+  EXPECT_FALSE(dm.ReadLog(log_buf, sizeof(log_buf), four_gb + 1 + sizeof(log_data)));
+
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, DirectIoTest) {
+  std::string db_file("test.db");
+  auto dm = DiskManager(db_file, true);
+  if (!dm.IsDirectIo()) {
+    GTEST_SKIP() << "the file system does not support O_DIRECT";
+  }
+
+  // An aligned page like a frame's, and one off by a byte like a buffer on the stack.
+  auto *aligned = static_cast<char *>(std::aligned_alloc(PAGE_SIZE, 2 * PAGE_SIZE));
+  std::vector<char> unaligned_storage(PAGE_SIZE + 1);
+  char *unaligned = unaligned_storage.data() + 1;
+  std::memset(aligned, 'a', PAGE_SIZE);
+  std::memset(unaligned, 'u', PAGE_SIZE);
+
+  dm.WritePage(0, aligned);
+  dm.WritePage(1, unaligned);
+  const char *write_data[] = {unaligned, aligned};
+  dm.WritePages({2, 3}, write_data);
+  dm.WritePageAsync(4, unaligned).wait();
+
+  char buf[PAGE_SIZE];
+  char *read_aligned = aligned + PAGE_SIZE;
+  const std::vector<char> expected{'a', 'u', 'u', 'a', 'u'};
+  for (page_id_t page_id = 0; page_id < 5; ++page_id) {
+    dm.ReadPage(page_id, buf);
+    EXPECT_EQ(expected[page_id], buf[0]);
+    EXPECT_EQ(expected[page_id], buf[PAGE_CHECKSUM_OFFSET - 1]);
+    dm.ReadPageAsync(page_id, read_aligned).wait();
+    EXPECT_EQ(std::memcmp(buf, read_aligned, PAGE_SIZE), 0);
+  }
+  // A batch running past the end of the file, into an unaligned and an aligned buffer.
+  char *read_data[] = {unaligned, read_aligned};
+  dm.ReadPages({4, 5}, read_data);
+  EXPECT_EQ('u', unaligned[0]);
+  EXPECT_EQ('\0', read_aligned[0]);
+  EXPECT_EQ('\0', read_aligned[PAGE_SIZE - 1]);
+  std::memset(buf, 'x', sizeof(buf));
+  dm.ReadPage(6, buf);
+  EXPECT_EQ('\0', buf[0]);
+  EXPECT_EQ(5 * PAGE_SIZE, dm.GetFileSize(db_file));
 
   dm.ShutDown();
+  std::free(aligned);
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, StripedFilesTest) {
+  std::string db_file("test.db");
+  const size_t stripe_pages = 2;
+  const int num_pages = 13;
+  char data[num_pages][PAGE_SIZE];
+  for (int i = 0; i < num_pages; ++i) {
+    std::memset(data[i], 0, PAGE_SIZE);
+    std::snprintf(data[i], PAGE_SIZE, "page %d", i);
+  }
+  {
+    auto dm = DiskManager(db_file, data_files_, stripe_pages);
+    EXPECT_EQ(3, dm.GetNumDataFiles());
+    EXPECT_EQ(0, dm.GetNumPages());
+    for (int i = 0; i < 6; ++i) {
+      dm.WritePage(i, data[i]);
+    }
+    // A batch spanning several stripe units.
+    std::vector<page_id_t> page_ids;
+    std::vector<const char *> write_data;
+    for (int i = 6; i < num_pages; ++i) {
+      page_ids.push_back(i);
+      write_data.push_back(data[i]);
+    }
+    dm.WritePages(page_ids, write_data.data());
+    EXPECT_EQ(num_pages, dm.GetNumPages());
+    dm.ShutDown();
+  }
+  // Scenario: a restart finds the layout saved next to the database.
+  auto dm = DiskManager(db_file);
+  EXPECT_EQ(3, dm.GetNumDataFiles());
+  EXPECT_EQ(num_pages, dm.GetNumPages());
+  // Units of two pages go round robin: 0-1, 6-7 and 12 in the first file, 2-3 and 8-9 in the second, and so on.
+  EXPECT_EQ(5 * PAGE_SIZE, dm.GetFileSize(data_files_[0]));
+  EXPECT_EQ(4 * PAGE_SIZE, dm.GetFileSize(data_files_[1]));
+  EXPECT_EQ(4 * PAGE_SIZE, dm.GetFileSize(data_files_[2]));
+  // db_file holds no pages, only the mark of a striped database.
+  EXPECT_GT(PAGE_SIZE, dm.GetFileSize(db_file));
+  char buf[PAGE_SIZE];
+  for (int i = 0; i < num_pages; ++i) {
+    dm.ReadPage(i, buf);
+    EXPECT_STREQ(data[i], buf);
+  }
+  char batch[num_pages][PAGE_SIZE];
+  std::vector<page_id_t> page_ids;
+  std::vector<char *> read_data;
+  for (int i = 0; i < num_pages; ++i) {
+    page_ids.push_back(i);
+    read_data.push_back(batch[i]);
+  }
+  dm.ReadPages(page_ids, read_data.data());
+  for (int i = 0; i < num_pages; ++i) {
+    EXPECT_STREQ(data[i], batch[i]);
+  }
+  dm.ShutDown();
+
+  // Scenario: the database can't be opened with another layout.
+  EXPECT_THROW(DiskManager(db_file, {data_files_[0], data_files_[1]}, stripe_pages), Exception);
+
+  // Scenario: a lost or damaged layout fails the open instead of starting over with db_file alone.
+  FILE *layout = fopen("test.tsp", "w");
+  fputs("garbage", layout);
+  fclose(layout);
+  EXPECT_THROW(DiskManager(db_file, data_files_, stripe_pages), Exception);
+  EXPECT_THROW(DiskManager{db_file}, Exception);
+  remove("test.tsp");
+  EXPECT_THROW(DiskManager(db_file, data_files_, stripe_pages), Exception);
+  EXPECT_THROW(DiskManager{db_file}, Exception);
+  EXPECT_GT(PAGE_SIZE, dm.GetFileSize(db_file));
+
+  // Scenario: a single file database that lost db_file but kept its log starts over, there is no layout to miss.
+  for (const auto &data_file : data_files_) {
+    remove(data_file.c_str());
+  }
+  remove(db_file.c_str());
+  char log_data[] = "log";
+  {
+    auto log_dm = DiskManager(db_file);
+    log_dm.WriteLog(log_data, sizeof(log_data));
+    log_dm.ShutDown();
+  }
+  remove(db_file.c_str());
+  auto single_dm = DiskManager(db_file);
+  EXPECT_EQ(1, single_dm.GetNumDataFiles());
+  single_dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, ChecksumTest) {
+  std::string db_file("test.db");
+  char data[PAGE_SIZE];
+  char buf[PAGE_SIZE];
+  {
+    auto dm = DiskManager(db_file);
+    for (page_id_t page_id = 0; page_id < 3; ++page_id) {
+      std::memset(data, 'a' + page_id, PAGE_SIZE);
+      dm.WritePage(page_id, data);
+    }
+    dm.ShutDown();
+  }
+
+  // Flip a byte of page 1 behind the disk manager's back.
+  int fd = open(db_file.c_str(), O_WRONLY);
+  ASSERT_GE(fd, 0);
+  ASSERT_EQ(1, pwrite(fd, "x", 1, PAGE_SIZE + 100));
+  close(fd);
+
+  // The checksums are part of the pages, and only the damaged page fails on every read path.
+  auto dm = DiskManager(db_file);
+  dm.ReadPage(0, buf);
+  EXPECT_EQ('a', buf[0]);
+  EXPECT_THROW(dm.ReadPage(1, buf), CorruptionException);
+  EXPECT_THROW(dm.ReadPageAsync(1, buf).get(), CorruptionException);
+  char *read_data[] = {data, buf};
+  EXPECT_THROW(dm.ReadPages({1, 2}, read_data), CorruptionException);
+  EXPECT_EQ('c', buf[0]);
+
+  // Writing the page again repairs it, and a page never written reads as zeroes.
+  std::memset(data, 'b', PAGE_SIZE);
+  dm.WritePageAsync(1, data).wait();
+  dm.ReadPage(1, buf);
+  EXPECT_EQ('b', buf[PAGE_CHECKSUM_OFFSET - 1]);
+  dm.ReadPage(5, buf);
+  EXPECT_EQ('\0', buf[0]);
+  dm.ShutDown();
+
+  // A stored checksum of zero is checked like any other, only a page of zeroes counts as never written.
+  std::memset(data, 'q', PAGE_CHECKSUM_OFFSET);
+  std::memset(data + PAGE_CHECKSUM_OFFSET, 0, PAGE_SIZE - PAGE_CHECKSUM_OFFSET);
+  fd = open(db_file.c_str(), O_WRONLY);
+  ASSERT_GE(fd, 0);
+  ASSERT_EQ(PAGE_SIZE, pwrite(fd, data, PAGE_SIZE, 2 * PAGE_SIZE));
+  close(fd);
+  auto reopened_dm = DiskManager(db_file);
+  EXPECT_THROW(reopened_dm.ReadPage(2, buf), CorruptionException);
+  reopened_dm.ShutDown();
 }
 
 // NOLINTNEXTLINE
@@ -66,9 +66,60 @@ TEST(TupleTest, DISABLED_TableHeapTest) {
   disk_manager->ShutDown();
   remove("test.db");  // remove db file
   remove("test.log");
+  remove("test.fsm0");
   delete table;
   delete buffer_pool_manager;
   delete disk_manager;
 }
 
+// NOLINTNEXTLINE
+TEST(TupleTest, TableIteratorReadAheadTest) {
+  Column col1{"a", TypeId::VARCHAR, 20};
+  Column col2{"b", TypeId::SMALLINT};
+  Column col3{"c", TypeId::BIGINT};
+  Column col4{"d", TypeId::BOOLEAN};
+  Column col5{"e", TypeId::VARCHAR, 16};
+  std::vector<Column> cols{col1, col2, col3, col4, col5};
+  Schema schema{cols};
+  Tuple tuple = ConstructTuple(&schema);
+
+  auto *transaction = new Transaction(0);
+  auto *disk_manager = new DiskManager("test.db");
+  auto *buffer_pool_manager = new BufferPoolManagerInstance(16, disk_manager);
+  auto *lock_manager = new LockManager();
+  auto *log_manager = new LogManager(disk_manager);
+  auto *table = new TableHeap(buffer_pool_manager, lock_manager, log_manager, transaction);
+
+  // The table spans far more pages than the buffer pool holds, so the scan keeps missing without read-ahead.
+  std::vector<RID> rid_v;
+  for (int i = 0; i < 5000; ++i) {
+    RID rid;
+    ASSERT_TRUE(table->InsertTuple(tuple, &rid, transaction));
+    rid_v.push_back(rid);
+  }
+
+  const size_t old_read_ahead_window = read_ahead_window;
+  for (size_t window : {0, 1, 4, 8}) {
+    read_ahead_window = window;
+    size_t i = 0;
+    for (auto itr = table->Begin(transaction); itr != table->End(); ++itr) {
+      ASSERT_LT(i, rid_v.size());
+      EXPECT_EQ(rid_v[i++], itr->GetRid());
+    }
+    EXPECT_EQ(rid_v.size(), i);
+  }
+  read_ahead_window = old_read_ahead_window;
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.log");
+  remove("test.fsm0");
+  delete table;
+  delete log_manager;
+  delete lock_manager;
+  delete buffer_pool_manager;
+  delete disk_manager;
+  delete transaction;
+}
+
 }  // namespace bustub